@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Benchmark of the Python bindings: cost of crossing the Python/C++ boundary
+and of converting edge lists to Python objects.
+
+Usage: python bench/bench_bindings.py [--quick] [--json path]
+"""
+
+import argparse
+import json
+import timeit
+from horgg import BCMS
+
+SEED = 42
+
+
+def bench(name, params, statement, nb_operations, min_seconds):
+    timer = timeit.Timer(statement)
+    number, seconds = timer.autorange()
+    while seconds < min_seconds:
+        number *= 2
+        seconds = timer.timeit(number)
+    ns_per_op = 1e9*seconds/(number*nb_operations)
+    print(f"{name:<24} {params:<28} {ns_per_op:12.1f} ns/op")
+    return {'name': name, 'params': params,
+            'operations': number*nb_operations, 'seconds': seconds,
+            'ns_per_op': ns_per_op}
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--quick', action='store_true')
+    parser.add_argument('--json', default=None)
+    args = parser.parse_args()
+    min_seconds = 0.05 if args.quick else 0.5
+
+    results = []
+    for nb_nodes in [1000, 100000]:
+        m_list = [4]*nb_nodes
+        n_list = [4]*nb_nodes
+        params = f"N={nb_nodes},E={4*nb_nodes}"
+        BCMS.seed(SEED)
+        sampler = BCMS(m_list, n_list)
+        results.append(bench('py_mcmc_step', params,
+                             sampler.mcmc_step, 1, min_seconds))
+        results.append(bench('py_get_graph', params,
+                             sampler.get_graph, 1, min_seconds))
+        results.append(bench('py_get_random_graph', params,
+                             lambda: sampler.get_random_graph(0), 1,
+                             min_seconds))
+        results.append(bench('py_construct', params,
+                             lambda: BCMS(m_list, n_list), 1, min_seconds))
+
+    if args.json is not None:
+        with open(args.json, 'w') as output:
+            json.dump({'seed': SEED, 'results': results}, output, indent=1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,461 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Benchmark suite for the bipartite configuration model sampler.
+ *
+ * Usage: bench_horgg [--quick] [--perf] [--filter substring] [--json path]
+ *
+ * Every case uses a fixed seed, so that runs are comparable across releases.
+ * With --perf, hardware counters are read with perf_event_open when the
+ * kernel allows it (see /proc/sys/kernel/perf_event_paranoid).
+ */
+
+#include "GraphGenerator.hpp"
+#include "SequenceGenerator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace horgg;
+
+namespace
+{//start of anonymous namespace
+
+const unsigned int SEED = 42;
+
+struct Options
+{
+    bool quick = false;
+    bool perf = false;
+    string filter;
+    string json_path;
+};
+
+/* =================
+ * Hardware counters
+ * ================= */
+
+struct CounterValues
+{
+    vector<pair<string, long long> > values;
+};
+
+class PerfCounters
+{
+public:
+    explicit PerfCounters(bool enabled)
+    {
+#ifdef __linux__
+        if (not enabled)
+        {
+            return;
+        }
+        add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        add("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        add("cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        add("branch_misses", PERF_TYPE_HARDWARE,
+                PERF_COUNT_HW_BRANCH_MISSES);
+        if (enabled and fds_.empty())
+        {
+            fprintf(stderr, "warning: hardware counters unavailable\n");
+        }
+#else
+        if (enabled)
+        {
+            fprintf(stderr, "warning: hardware counters need Linux\n");
+        }
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (int fd : fds_)
+        {
+            close(fd);
+        }
+#endif
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        for (int fd : fds_)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    CounterValues stop()
+    {
+        CounterValues counters;
+#ifdef __linux__
+        for (size_t i = 0; i < fds_.size(); i++)
+        {
+            ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+            long long value = 0;
+            if (read(fds_[i], &value, sizeof(value)) == sizeof(value))
+            {
+                counters.values.emplace_back(names_[i], value);
+            }
+        }
+#endif
+        return counters;
+    }
+
+private:
+    vector<int> fds_;
+    vector<string> names_;
+
+#ifdef __linux__
+    void add(const string& name, unsigned int type, unsigned long long config)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd >= 0)
+        {
+            fds_.push_back(fd);
+            names_.push_back(name);
+        }
+    }
+#endif
+};
+
+/* =================
+ * Sequences
+ * ================= */
+
+//every node belongs to m groups, every group has n nodes
+pair<MembershipSequence, GroupSizeSequence> regular_sequences(
+        unsigned int nb_nodes, unsigned int m, unsigned int n)
+{
+    return make_pair(MembershipSequence(nb_nodes, m),
+            GroupSizeSequence(nb_nodes*m/n, n));
+}
+
+//power-law distributed value in [1,kmax] with exponent 2.5
+unsigned int power_law_value(unsigned int kmax, RNGType& gen)
+{
+    double u = generate_canonical<double,
+          numeric_limits<double>::digits>(gen);
+    double value = pow(1 - u*(1 - pow(kmax+1., -1.5)), -1/1.5);
+    return min(kmax, static_cast<unsigned int>(value));
+}
+
+//heavy-tailed memberships and group sizes, completed with 1s to match sums
+pair<MembershipSequence, GroupSizeSequence> heavy_tailed_sequences(
+        unsigned int nb_nodes, RNGType& gen)
+{
+    unsigned int kmax = sqrt(nb_nodes);
+    MembershipSequence membership_sequence;
+    GroupSizeSequence group_size_sequence;
+    unsigned long long membership_sum = 0;
+    unsigned long long group_size_sum = 0;
+    for (unsigned int i = 0; i < nb_nodes; i++)
+    {
+        membership_sequence.push_back(power_law_value(kmax, gen));
+        membership_sum += membership_sequence.back();
+        group_size_sequence.push_back(power_law_value(kmax, gen)+1);
+        group_size_sum += group_size_sequence.back();
+    }
+    for (; membership_sum < group_size_sum; membership_sum++)
+    {
+        membership_sequence.push_back(1);
+    }
+    for (; group_size_sum < membership_sum; group_size_sum++)
+    {
+        group_size_sequence.push_back(1);
+    }
+    return make_pair(membership_sequence, group_size_sequence);
+}
+
+/* =================
+ * Runner
+ * ================= */
+
+struct Result
+{
+    string name;
+    string params;
+    unsigned long long nb_operations;
+    double seconds;
+    CounterValues counters;
+};
+
+class Runner
+{
+public:
+    explicit Runner(const Options& options):
+        options_(options), counters_(options.perf) {}
+
+    //time `body`, which performs `nb_operations` operations per call,
+    //until the minimal duration is reached
+    void run(const string& name, const string& params,
+            unsigned long long nb_operations, const function<void()>& body)
+    {
+        if (not options_.filter.empty()
+                and name.find(options_.filter) == string::npos)
+        {
+            return;
+        }
+        double min_seconds = options_.quick ? 0.01 : 0.5;
+        Result result{name, params, 0, 0., CounterValues()};
+        vector<CounterValues> counters;
+        while (result.seconds < min_seconds)
+        {
+            counters_.start();
+            auto start = chrono::steady_clock::now();
+            body();
+            auto end = chrono::steady_clock::now();
+            counters.push_back(counters_.stop());
+            result.seconds += chrono::duration<double>(end-start).count();
+            result.nb_operations += nb_operations;
+        }
+        //sum the counters over repetitions
+        result.counters = counters.front();
+        for (size_t i = 1; i < counters.size(); i++)
+        {
+            for (size_t j = 0; j < result.counters.values.size(); j++)
+            {
+                result.counters.values[j].second +=
+                    counters[i].values[j].second;
+            }
+        }
+        printf("%-24s %-28s %12.1f ns/op %14.0f op/s\n", name.c_str(),
+                params.c_str(), 1e9*result.seconds/result.nb_operations,
+                result.nb_operations/result.seconds);
+        results_.push_back(result);
+    }
+
+    void write_json() const
+    {
+        if (options_.json_path.empty())
+        {
+            return;
+        }
+        FILE* file = fopen(options_.json_path.c_str(), "w");
+        if (file == nullptr)
+        {
+            throw runtime_error("Cannot open " + options_.json_path);
+        }
+        fprintf(file, "{\"seed\":%u,\"results\":[", SEED);
+        for (size_t i = 0; i < results_.size(); i++)
+        {
+            const Result& result = results_[i];
+            fprintf(file, "%s\n{\"name\":\"%s\",\"params\":\"%s\","
+                    "\"operations\":%llu,\"seconds\":%.9f,"
+                    "\"ns_per_op\":%.3f,\"counters\":{", i ? "," : "",
+                    result.name.c_str(), result.params.c_str(),
+                    result.nb_operations, result.seconds,
+                    1e9*result.seconds/result.nb_operations);
+            for (size_t j = 0; j < result.counters.values.size(); j++)
+            {
+                fprintf(file, "%s\"%s\":%lld", j ? "," : "",
+                        result.counters.values[j].first.c_str(),
+                        result.counters.values[j].second);
+            }
+            fprintf(file, "}}");
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+    }
+
+private:
+    Options options_;
+    PerfCounters counters_;
+    vector<Result> results_;
+};
+
+string params_string(unsigned int nb_nodes, unsigned int nb_edges)
+{
+    return "N=" + to_string(nb_nodes) + ",E=" + to_string(nb_edges);
+}
+
+/* =================
+ * Benchmarks
+ * ================= */
+
+//swaps per second as a function of the size and the density
+void bench_mcmc_step(Runner& runner, const Options& options)
+{
+    vector<unsigned int> sizes = {1000, 10000, 100000};
+    if (not options.quick)
+    {
+        sizes.push_back(1000000);
+    }
+    for (unsigned int nb_nodes : sizes)
+    {
+        for (unsigned int m : {2, 8})
+        {
+            auto sequences = regular_sequences(nb_nodes, m, 4);
+            BaseGenerator::seed(SEED);
+            BipartiteConfigurationModelSampler sampler(sequences.first,
+                    sequences.second);
+            unsigned int nb_steps = 100000;
+            runner.run("mcmc_step", params_string(nb_nodes, nb_nodes*m),
+                    nb_steps, [&]()
+                    {
+                        for (unsigned int i = 0; i < nb_steps; i++)
+                        {
+                            sampler.mcmc_step();
+                        }
+                    });
+        }
+    }
+}
+
+//full stub matching (shuffle, repair, edge set) for both kinds of sequences
+void bench_stub_matching(Runner& runner, const Options& options)
+{
+    vector<unsigned int> sizes = {1000, 100000};
+    if (not options.quick)
+    {
+        sizes.push_back(1000000);
+    }
+    for (unsigned int nb_nodes : sizes)
+    {
+        RNGType gen(SEED);
+        vector<pair<string, pair<MembershipSequence, GroupSizeSequence> > >
+            cases = {
+                {"stub_matching_regular", regular_sequences(nb_nodes, 4, 4)},
+                {"stub_matching_heavy", heavy_tailed_sequences(nb_nodes, gen)}
+            };
+        for (auto& bench_case : cases)
+        {
+            auto& sequences = bench_case.second;
+            BaseGenerator::seed(SEED);
+            BipartiteConfigurationModelSampler sampler(sequences.first,
+                    sequences.second);
+            runner.run(bench_case.first, params_string(
+                        sequences.first.size(), sampler.get_graph().size()),
+                    1, [&](){sampler.get_random_graph(0);});
+        }
+    }
+}
+
+//Gale-Ryser test
+void bench_is_bigraphic(Runner& runner, const Options& options)
+{
+    vector<unsigned int> sizes = {1000, 100000};
+    if (not options.quick)
+    {
+        sizes.push_back(1000000);
+    }
+    for (unsigned int nb_nodes : sizes)
+    {
+        RNGType gen(SEED);
+        auto sequences = heavy_tailed_sequences(nb_nodes, gen);
+        runner.run("is_bigraphic", params_string(sequences.first.size(),
+                    accumulate(sequences.first.begin(),
+                        sequences.first.end(), 0ull)),
+                1, [&]()
+                {
+                    BipartiteConfigurationModelSampler::is_bigraphic(
+                            sequences.first, sequences.second);
+                });
+    }
+}
+
+//alias sampling of sequences from a heavy-tailed distribution
+void bench_sequences(Runner& runner, const Options& options)
+{
+    unsigned int size = options.quick ? 100000 : 10000000;
+    vector<double> dist(1001, 0.);
+    for (unsigned int k = 1; k < dist.size(); k++)
+    {
+        dist[k] = pow(k, -2.5);
+    }
+    RNGType gen(SEED);
+    vector<unsigned int> seq_1(size);
+    runner.run("sequence_1", "N=" + to_string(size), size, [&]()
+            {
+                sequence_1(seq_1.data(), size, dist, gen);
+            });
+    runner.run("sequence_2", "N=" + to_string(size), size, [&]()
+            {
+                sequence_2(seq_1, dist, gen);
+            });
+}
+
+}//end of anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg(argv[i]);
+        if (arg == "--quick")
+        {
+            options.quick = true;
+        }
+        else if (arg == "--perf")
+        {
+            options.perf = true;
+        }
+        else if (arg == "--filter" and i+1 < argc)
+        {
+            options.filter = argv[++i];
+        }
+        else if (arg == "--json" and i+1 < argc)
+        {
+            options.json_path = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--quick] [--perf] "
+                    "[--filter substring] [--json path]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Runner runner(options);
+    bench_mcmc_step(runner, options);
+    bench_stub_matching(runner, options);
+    bench_is_bigraphic(runner, options);
+    bench_sequences(runner, options);
+    runner.write_json();
+    return 0;
+}
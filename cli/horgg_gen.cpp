@@ -0,0 +1,243 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Command-line generator of random bipartite graphs.
+ *
+ * Reads a membership sequence and a group size sequence (whitespace-separated
+ * integers) and writes nb_graphs edge lists, one "node group" pair per line,
+ * to <prefix>_<i>.txt, all of them to the binary ensemble file
+ * <prefix>.horgg (see EnsembleIO.hpp), or to the shared-memory segment
+ * /<prefix> (see SharedEnsemble.hpp).
+ */
+
+#include "GraphGenerator.hpp"
+#include "EnsembleIO.hpp"
+#include "SharedEnsemble.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace horgg;
+
+namespace
+{//start of anonymous namespace
+
+const char* USAGE =
+    "usage: horgg-gen -m membership_file -n group_size_file\n"
+    "                 [-N nb_graphs] [-s nb_steps] [--seed seed]"
+    " [-o prefix]\n"
+    "                 [--format text|binary|raw|shm]\n"
+    "\n"
+    "  -m        file with the membership sequence\n"
+    "  -n        file with the group size sequence\n"
+    "  -N        number of graphs to generate (default 1)\n"
+    "  -s        number of edge swaps per graph (default 0)\n"
+    "  --seed    seed of the RNG (default: time)\n"
+    "  -o        prefix of the output files (default graph)\n"
+    "  --format  text files, compressed binary or uncompressed binary\n"
+    "            ensemble, or shared-memory segment /prefix left for the\n"
+    "            consumers to unlink (default text)\n";
+
+//parse a decimal integer in [0, largest]; false for anything else
+bool parse_unsigned(const string& value, unsigned long long largest,
+        unsigned long long& result)
+{
+    if (value.empty() or value.size() > 20
+            or value.find_first_not_of("0123456789") != string::npos)
+    {
+        return false;
+    }
+    errno = 0;
+    result = strtoull(value.c_str(), nullptr, 10);
+    return errno == 0 and result <= largest;
+}
+
+vector<unsigned int> read_sequence(const string& path)
+{
+    ifstream input(path);
+    if (not input)
+    {
+        throw runtime_error("Cannot open " + path);
+    }
+    vector<unsigned int> sequence;
+    unsigned long long value;
+    while (input >> value)
+    {
+        if (value > numeric_limits<unsigned int>::max())
+        {
+            throw runtime_error("Integer out of range in " + path);
+        }
+        sequence.push_back(value);
+    }
+    if (not input.eof())
+    {
+        throw runtime_error("Invalid integer in " + path);
+    }
+    return sequence;
+}
+
+void write_edge_list(const string& path, const EdgeList& edge_list)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        throw runtime_error("Cannot open " + path);
+    }
+    for (auto& edge : edge_list)
+    {
+        fprintf(file, "%u %u\n", edge.first, edge.second);
+    }
+    if (fclose(file) != 0)
+    {
+        throw runtime_error("Cannot write " + path);
+    }
+}
+
+}//end of anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    string membership_path;
+    string group_size_path;
+    string prefix = "graph";
+    string format = "text";
+    unsigned long long nb_graphs = 1;
+    unsigned long long nb_steps = 0;
+    bool seeded = false;
+    unsigned long long seed_value = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg(argv[i]);
+        if (arg == "-h" or arg == "--help")
+        {
+            printf("%s", USAGE);
+            return 0;
+        }
+        if (i+1 >= argc)
+        {
+            fprintf(stderr, "%s", USAGE);
+            return 1;
+        }
+        string value(argv[++i]);
+        bool valid = true;
+        if (arg == "-m")
+        {
+            membership_path = value;
+        }
+        else if (arg == "-n")
+        {
+            group_size_path = value;
+        }
+        else if (arg == "-N")
+        {
+            valid = parse_unsigned(value, numeric_limits<size_t>::max(),
+                    nb_graphs);
+        }
+        else if (arg == "-s")
+        {
+            valid = parse_unsigned(value, numeric_limits<unsigned int>::max(),
+                    nb_steps);
+        }
+        else if (arg == "--seed")
+        {
+            seeded = true;
+            valid = parse_unsigned(value, numeric_limits<unsigned int>::max(),
+                    seed_value);
+        }
+        else if (arg == "-o")
+        {
+            prefix = value;
+        }
+        else if (arg == "--format"
+                and (value == "text" or value == "binary" or value == "raw"
+                    or value == "shm"))
+        {
+            format = value;
+        }
+        else
+        {
+            valid = false;
+        }
+        if (not valid)
+        {
+            fprintf(stderr, "%s", USAGE);
+            return 1;
+        }
+    }
+    if (membership_path.empty() or group_size_path.empty())
+    {
+        fprintf(stderr, "%s", USAGE);
+        return 1;
+    }
+
+    try
+    {
+        if (seeded)
+        {
+            BaseGenerator::seed(seed_value);
+        }
+        MembershipSequence membership_sequence =
+            read_sequence(membership_path);
+        GroupSizeSequence group_size_sequence =
+            read_sequence(group_size_path);
+        BipartiteConfigurationModelSampler sampler(membership_sequence,
+                group_size_sequence);
+        if (format == "text")
+        {
+            for (unsigned long long i = 0; i < nb_graphs; i++)
+            {
+                write_edge_list(prefix + "_" + to_string(i) + ".txt",
+                        sampler.get_random_graph(nb_steps));
+            }
+        }
+        else if (format == "shm")
+        {
+            SharedEnsembleWriter writer("/" + prefix, membership_sequence,
+                    group_size_sequence, nb_graphs, BaseGenerator::get_seed());
+            writer.write_random_graphs(sampler, nb_graphs, nb_steps);
+        }
+        else
+        {
+            EnsembleWriter writer(prefix + ".horgg", membership_sequence,
+                    group_size_sequence, BaseGenerator::get_seed(),
+                    format == "binary");
+            writer.write_random_graphs(sampler, nb_graphs, nb_steps);
+            writer.close();
+        }
+    }
+    catch (exception& e)
+    {
+        fprintf(stderr, "horgg-gen: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
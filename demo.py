@@ -49,3 +49,11 @@ print(edge_list)
 #get node adjacency
 node_to_node_adjacency = get_node_to_node_adjacency(edge_list)
 print(node_to_node_adjacency)
+
+#alternatively, let the sampler choose the burn-in and the thinning from the
+#autocorrelation of the chain, within a budget of edge swaps
+schedule = horgg.tune_chain(graph_generator, max_steps=100*N)
+graphs = []
+for _ in range(10):
+    graph_generator.mcmc_step(schedule.thinning_steps)
+    graphs.append(graph_generator.get_graph())
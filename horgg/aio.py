@@ -0,0 +1,63 @@
+"""
+asyncio front end: the graphs are sampled on a pool of C++ threads and the
+coroutines only await the result, so the event loop is never blocked.
+Cancelling a coroutine stops the corresponding chain, and the chains still
+running at exit are stopped.
+"""
+
+import asyncio
+from _horgg import _submit_random_graph
+
+def _resolve(future, edges, error):
+    """_resolve completes future unless it was already cancelled."""
+    if future.done():
+        return
+    if error is not None:
+        future.set_exception(error)
+    else:
+        future.set_result(edges)
+
+async def get_random_graph(sampler, nb_steps=0, seed=None, stream=0):
+    """get_random_graph samples a graph like sampler.get_random_graph,
+    keeping its frozen edges and classes, from a copy of sampler taken when
+    the coroutine starts, so that sampler is not modified.
+
+    :param sampler: BCMS object
+    :param nb_steps: int for the number of edge swaps
+    :param seed: int for the seed of the RNG (None draws one from sampler)
+    :param stream: int for the stream of the RNG
+    :returns: (nb_edges, 2) array of (node, group) pairs
+    """
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+    def done(edges, error):
+        loop.call_soon_threadsafe(_resolve, future, edges, error)
+    token = _submit_random_graph(sampler, nb_steps, seed, stream, done)
+    try:
+        return await future
+    except asyncio.CancelledError:
+        token.cancel()
+        raise
+
+async def get_random_graphs(sampler, nb_graphs, nb_steps=0, seed=None):
+    """get_random_graphs samples nb_graphs graphs concurrently, graph i with
+    stream i of the RNG seeded with seed.
+
+    :param sampler: BCMS object
+    :param nb_graphs: int for the number of graphs
+    :param nb_steps: int for the number of edge swaps per graph
+    :param seed: int for the seed of the RNG (None draws one from sampler)
+    :returns: list of (nb_edges, 2) arrays of (node, group) pairs
+    """
+    if seed is None:
+        seed = sampler.draw_seed()
+    tasks = [asyncio.ensure_future(
+        get_random_graph(sampler, nb_steps, seed, stream))
+        for stream in range(nb_graphs)]
+    try:
+        return await asyncio.gather(*tasks)
+    except BaseException:
+        #gather leaves the other chains running when one of them fails
+        for task in tasks:
+            task.cancel()
+        raise
@@ -3,46 +3,57 @@ Utility functions
 """
 
 import numpy as np
-from numpy.random import random
+from _horgg import _sequence_1, _sequence_2, _sequence_2_exact
 
-def sequence_1(N, dist):
+def _draw_seed(seed):
+    """_draw_seed returns seed, or a seed drawn from numpy.random if it is
+    None, so that numpy.random.seed makes the sequences reproducible.
+    """
+    if seed is None:
+        seed = np.random.randint(0, 2**32, dtype=np.uint64)
+    return int(seed)
+
+def sequence_1(N, dist, seed=None):
     """sequence_1 returns a sequence of value distributed
     according to dist.
 
     :param N: int for the size of the sequence
     :param dist: array for the distribution
+    :param seed: int for the seed of the RNG (drawn from numpy.random if None)
     """
     #dist must start at 0
-    cum_dist = np.cumsum(dist)
-    sequence = []
-    for i in range(N):
-        u = random()
-        m = np.searchsorted(cum_dist, u)
-        sequence.append(m)
-    return sequence
-
-def sequence_2(seq_1,dist):
+    return _sequence_1(N, np.asarray(dist, dtype=float), _draw_seed(seed))
+
+def sequence_2(seq_1,dist, seed=None):
     """sequence_2 returns a sequence of value distributed according
     to dist and is coherent with seq_1
 
     :param seq_1: array for sequence of int.
     :param dist: array for the distribution
+    :param seed: int for the seed of the RNG (drawn from numpy.random if None)
     """
-    seq_1_stub = np.sum(seq_1)
     #dist must start at 0
-    cum_dist = np.cumsum(dist)
-    seq_2 = []
-    seq_2_stub = 0
-    #generate new sequence number until the sum is coherent with seq_1
-    while (seq_2_stub != seq_1_stub):
-        if seq_2_stub < seq_1_stub:
-            u = random()
-            n = np.searchsorted(cum_dist, u)
-            seq_2.append(n)
-            seq_2_stub += n
-        elif seq_2_stub > seq_1_stub:
-            index = int(np.floor(random()*len(seq_2)))
-            seq_2[index], seq_2[-1] = seq_2[-1], seq_2[index]
-            seq_2_stub -= seq_2.pop()
-    return seq_2
+    return _sequence_2(seq_1, np.asarray(dist, dtype=float),
+                       _draw_seed(seed))
+
+def sequence_2_exact(seq_1, dist, seed=None, ensure_bigraphic=False,
+                     max_attempts=100):
+    """sequence_2_exact returns a sequence of value distributed according
+    to dist, conditioned on its partial sums hitting exactly the sum of seq_1
+    (the distribution sequence_2 aims at). After a table whose size grows
+    with the gaps of the support of dist, it runs in expected time linear
+    in the length of the sequence, without the append/pop loop of
+    sequence_2. Raises ValueError if the support is too wide and sparse for
+    the table (use sequence_2 instead).
 
+    :param seq_1: array for sequence of int.
+    :param dist: array for the distribution
+    :param seed: int for the seed of the RNG (drawn from numpy.random if None)
+    :param ensure_bigraphic: bool to redraw the sequence until it is
+                             bigraphic with seq_1
+    :param max_attempts: int for the maximal number of draws when
+                         ensure_bigraphic is True
+    """
+    #dist must start at 0
+    return _sequence_2_exact(seq_1, np.asarray(dist, dtype=float),
+                             _draw_seed(seed), ensure_bigraphic, max_attempts)
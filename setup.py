@@ -24,12 +24,28 @@ class get_pybind_include(object):
 ext_modules = [
     Extension(
         '_horgg',
-        ['src/bind_horgg.cpp', 'src/GraphGenerator.cpp'],
+        ['src/bind_horgg.cpp',
+         'src/Convergence.cpp',
+         'src/EnsembleIO.cpp',
+         'src/GraphGenerator.cpp',
+         'src/GroupStatistics.cpp',
+         'src/Hyperedges.cpp',
+         'src/Incidence.cpp',
+         'src/JointDegree.cpp',
+         'src/MetropolisHastings.cpp',
+         'src/Pipeline.cpp',
+         'src/Prefetcher.cpp',
+         'src/SequenceGenerator.cpp',
+         'src/SharedEnsemble.cpp',
+         'src/SwapLog.cpp',
+         'src/Trace.cpp'],
         include_dirs=[
             'src/',
             get_pybind_include(),
             get_pybind_include(user=True)
         ],
+        #shm_open is in librt before glibc 2.34
+        libraries=['rt'] if sys.platform.startswith('linux') else [],
         language='c++'
     ),
 ]
@@ -99,7 +115,7 @@ setup(
     long_description='',
     packages=setuptools.find_packages(),
     ext_modules=ext_modules,
-    install_requires=['pybind11>=2.2'],
+    install_requires=['pybind11>=2.2', 'numpy'],
     cmdclass={'build_ext': BuildExt},
     zip_safe=False,
 )
@@ -0,0 +1,272 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Convergence.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+namespace
+{//start of anonymous namespace
+
+//minimal number of autocorrelation times in the retained half
+const double MIN_NB_AUTOCORRELATION_TIMES = 50.;
+//maximal difference between the means of the two quarters, in standard
+//errors
+const double MAX_DRIFT = 3.;
+//number of records before the first check
+const size_t MIN_NB_RECORDS = 64;
+//seed of the random weights of the observables, independent of the sampler
+const unsigned int OBSERVABLE_SEED = 0x5eed;
+
+/*
+ * Sums over the edges of node_weight[node]*group_weight[group] for two sets
+ * of weights: membership times group size (degree correlations) and random
+ * signs (which nodes share groups). A swap changes two terms of each sum,
+ * so the observables cost O(1) per swap.
+ */
+class EdgeWeightSums : public SwapObserver
+{
+public:
+    static const size_t NB_OBSERVABLES = 2;
+
+    explicit EdgeWeightSums(BipartiteConfigurationModelSampler& sampler):
+        sampler_(sampler),
+        node_weights_(),
+        group_weights_(),
+        sums_()
+    {
+        MembershipSequence membership_sequence =
+            sampler.get_membership_sequence();
+        GroupSizeSequence group_size_sequence =
+            sampler.get_group_size_sequence();
+        RNGType gen(OBSERVABLE_SEED);
+        node_weights_[0].assign(membership_sequence.begin(),
+                membership_sequence.end());
+        group_weights_[0].assign(group_size_sequence.begin(),
+                group_size_sequence.end());
+        for (size_t node = 0; node < membership_sequence.size(); node++)
+        {
+            node_weights_[1].push_back(random_int(2, gen) ? 1. : -1.);
+        }
+        for (size_t group = 0; group < group_size_sequence.size(); group++)
+        {
+            group_weights_[1].push_back(random_int(2, gen) ? 1. : -1.);
+        }
+        sampler_.attach(this);
+    }
+    ~EdgeWeightSums() {sampler_.detach(this);}
+
+    EdgeWeightSums(const EdgeWeightSums&) = delete;
+    EdgeWeightSums& operator=(const EdgeWeightSums&) = delete;
+
+    void on_reset(const EdgeList& edge_list) override
+    {
+        for (size_t k = 0; k < NB_OBSERVABLES; k++)
+        {
+            sums_[k] = 0.;
+            for (auto& edge : edge_list)
+            {
+                sums_[k] += node_weights_[k][edge.first]
+                    *group_weights_[k][edge.second];
+            }
+        }
+    }
+
+    void on_swap(size_t, size_t, Node node1, Group group1, Node node2,
+            Group group2) override
+    {
+        for (size_t k = 0; k < NB_OBSERVABLES; k++)
+        {
+            sums_[k] += (node_weights_[k][node1] - node_weights_[k][node2])
+                *(group_weights_[k][group2] - group_weights_[k][group1]);
+        }
+    }
+
+    double get_sum(size_t k) const {return sums_[k];}
+
+private:
+    BipartiteConfigurationModelSampler& sampler_;
+    vector<double> node_weights_[NB_OBSERVABLES];
+    vector<double> group_weights_[NB_OBSERVABLES];
+    double sums_[NB_OBSERVABLES];
+};
+
+double mean(vector<double>::const_iterator first,
+        vector<double>::const_iterator last)
+{
+    double total = 0.;
+    for (auto it = first; it != last; ++it)
+    {
+        total += *it;
+    }
+    return total/(last - first);
+}
+
+//check the second half of the records of an observable; returns the
+//autocorrelation time in records, or a negative value if not stationary
+double stationary_autocorrelation_time(const vector<double>& records)
+{
+    vector<double> half(records.begin() + records.size()/2, records.end());
+    double tau = integrated_autocorrelation_time(half);
+    if (half.size() < MIN_NB_AUTOCORRELATION_TIMES*tau)
+    {
+        return -1.;
+    }
+
+    //compare the two quarters with the variance of their difference
+    size_t quarter = half.size()/2;
+    double first_mean = mean(half.begin(), half.begin() + quarter);
+    double second_mean = mean(half.begin() + quarter, half.end());
+    double half_mean = mean(half.begin(), half.end());
+    double variance = 0.;
+    for (double x : half)
+    {
+        variance += (x - half_mean)*(x - half_mean);
+    }
+    variance /= half.size();
+    double error = sqrt(2*variance*tau/quarter);
+    if (abs(first_mean - second_mean) > MAX_DRIFT*error)
+    {
+        return -1.;
+    }
+    return tau;
+}
+
+}//end of anonymous namespace
+
+double integrated_autocorrelation_time(const vector<double>& series,
+        double window_factor)
+{
+    size_t n = series.size();
+    if (n < 2)
+    {
+        return 1.;
+    }
+    double series_mean = mean(series.begin(), series.end());
+    double variance = 0.;
+    for (double x : series)
+    {
+        variance += (x - series_mean)*(x - series_mean);
+    }
+    if (variance == 0.)
+    {
+        return 1.;
+    }
+
+    double tau = 1.;
+    for (size_t lag = 1; lag < n; lag++)
+    {
+        double covariance = 0.;
+        for (size_t i = 0; i + lag < n; i++)
+        {
+            covariance += (series[i] - series_mean)*
+                (series[i+lag] - series_mean);
+        }
+        tau += 2*covariance/variance;
+        if (lag >= window_factor*tau)
+        {
+            break;
+        }
+    }
+    return max(tau, 1.);
+}
+
+ChainSchedule tune_chain(BipartiteConfigurationModelSampler& sampler,
+        size_t max_steps, size_t interval)
+{
+    trace::Span span("tune_chain");
+    sampler.get_random_graph(0);
+    if (interval == 0)
+    {
+        interval = max(sampler.get_graph().size()/10, size_t(1));
+    }
+
+    EdgeWeightSums observables(sampler);
+    vector<vector<double> > records(EdgeWeightSums::NB_OBSERVABLES);
+    ChainSchedule schedule{0, interval, double(interval), false, 0};
+    size_t next_check = MIN_NB_RECORDS;
+    while (schedule.nb_steps + interval <= max_steps)
+    {
+        for (size_t i = 0; i < interval; i++)
+        {
+            sampler.mcmc_step();
+        }
+        schedule.nb_steps += interval;
+        for (size_t k = 0; k < records.size(); k++)
+        {
+            records[k].push_back(observables.get_sum(k));
+        }
+
+        if (records[0].size() == next_check)
+        {
+            next_check *= 2;
+            double tau = 1.;
+            bool converged = true;
+            for (auto& observable : records)
+            {
+                double observable_tau =
+                    stationary_autocorrelation_time(observable);
+                converged = converged and observable_tau > 0;
+                tau = max(tau, observable_tau);
+            }
+            if (converged)
+            {
+                //the discarded first half of the records
+                schedule.burn_in_steps = records[0].size()/2*interval;
+                schedule.autocorrelation_time = tau*interval;
+                schedule.converged = true;
+                break;
+            }
+        }
+    }
+
+    if (not schedule.converged)
+    {
+        schedule.burn_in_steps = schedule.nb_steps;
+    }
+    if (not schedule.converged and records[0].size() >= 2)
+    {
+        //best estimate with the records available
+        double tau = 1.;
+        for (auto& observable : records)
+        {
+            vector<double> half(observable.begin() + observable.size()/2,
+                    observable.end());
+            tau = max(tau, integrated_autocorrelation_time(half));
+        }
+        schedule.autocorrelation_time = tau*interval;
+    }
+    schedule.thinning_steps = max(
+            size_t(ceil(2*schedule.autocorrelation_time)), interval);
+    return schedule;
+}
+
+}//end of namespace horgg
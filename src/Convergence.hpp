@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CONVERGENCE_HPP_
+#define CONVERGENCE_HPP_
+
+#include "GraphGenerator.hpp"
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Number of edge swaps to use along a chain, estimated from the integrated
+ * autocorrelation time of cheap observables of the graph.
+ */
+struct ChainSchedule
+{
+    //swaps after the stub matching before the observables became
+    //stationary (all the swaps performed if they did not)
+    std::size_t burn_in_steps;
+    //swaps between two effectively independent graphs
+    std::size_t thinning_steps;
+    //largest integrated autocorrelation time of the observables, in swaps
+    double autocorrelation_time;
+    //false if the budget was exhausted before the criteria were met
+    bool converged;
+    //swaps performed by the tuning run
+    std::size_t nb_steps;
+};
+
+//integrated autocorrelation time (in samples) of a series, with the
+//self-consistent window of Sokal: smallest M such that M >= c tau(M)
+double integrated_autocorrelation_time(const std::vector<double>& series,
+        double window_factor=5.);
+
+/*
+ * Start a new chain from a stub matching and perform swaps until it looks
+ * stationary, using at most max_steps swaps. The current graph of the
+ * sampler is discarded. Two sums over the edges, updated in O(1) per swap,
+ * are recorded every interval swaps (0 uses a tenth of the number of
+ * edges): the products of membership and group size, and the products of
+ * fixed random signs of the nodes and groups. Every time the number of
+ * records doubles, the first half is discarded as burn-in and the chain is
+ * accepted if the second half spans at least 50 autocorrelation times and
+ * the means of its two quarters agree. The sampler is left at the last
+ * state, ready to be thinned with mcmc_step.
+ */
+ChainSchedule tune_chain(BipartiteConfigurationModelSampler& sampler,
+        std::size_t max_steps, std::size_t interval=0);
+
+}//end of namespace horgg
+
+#endif /* CONVERGENCE_HPP_ */
@@ -0,0 +1,460 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "EnsembleIO.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+static_assert(sizeof(pair<Node,Group>) == 2*sizeof(uint32_t),
+        "edges must be stored as contiguous pairs of uint32");
+
+namespace
+{//start of anonymous namespace
+
+const size_t NB_GRAPHS_OFFSET = 48;
+const size_t SEQUENCES_OFFSET = 56;
+
+size_t align8(size_t offset)
+{
+    return (offset + 7) & ~size_t(7);
+}
+
+void write_varint(uint32_t value, vector<unsigned char>& output)
+{
+    while (value >= 0x80)
+    {
+        output.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    output.push_back(value);
+}
+
+uint32_t read_varint(const unsigned char*& input, const unsigned char* end)
+{
+    uint32_t value = 0;
+    for (unsigned int shift = 0; shift < 35; shift += 7)
+    {
+        if (input == end)
+        {
+            break;
+        }
+        unsigned char byte = *input++;
+        value |= uint32_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    throw runtime_error("Corrupted compressed graph in ensemble file.");
+}
+
+template <typename T>
+T read_value(const unsigned char* data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+}//end of anonymous namespace
+
+/* =================
+ * EnsembleWriter
+ * ================= */
+
+EnsembleWriter::EnsembleWriter(const string& path,
+        const MembershipSequence& membership_sequence,
+        const GroupSizeSequence& group_size_sequence,
+        uint64_t seed, bool compress):
+    file_(fopen(path.c_str(), "wb")),
+    compress_(compress),
+    membership_sequence_(membership_sequence),
+    nb_groups_(group_size_sequence.size()),
+    nb_edges_(accumulate(membership_sequence.begin(),
+                membership_sequence.end(), uint64_t(0))),
+    nb_graphs_(0),
+    nb_graphs_offset_(NB_GRAPHS_OFFSET),
+    node_offset_(),
+    node_cursor_(),
+    sorted_groups_(),
+    payload_()
+{
+    if (file_ == nullptr)
+    {
+        throw runtime_error("Cannot open " + path);
+    }
+    //the reader checks both sums against the number of edges
+    if (accumulate(group_size_sequence.begin(), group_size_sequence.end(),
+                uint64_t(0)) != nb_edges_)
+    {
+        fclose(file_);
+        throw invalid_argument("Sequences do not sum to the same value.");
+    }
+    uint32_t flags = compress_ ? ENSEMBLE_COMPRESSED : 0;
+    uint64_t nb_nodes = membership_sequence.size();
+    uint64_t nb_groups = nb_groups_;
+    try
+    {
+        write_bytes(ENSEMBLE_MAGIC, sizeof(ENSEMBLE_MAGIC));
+        write_bytes(&ENSEMBLE_VERSION, sizeof(ENSEMBLE_VERSION));
+        write_bytes(&flags, sizeof(flags));
+        write_bytes(&seed, sizeof(seed));
+        write_bytes(&nb_nodes, sizeof(nb_nodes));
+        write_bytes(&nb_groups, sizeof(nb_groups));
+        write_bytes(&nb_edges_, sizeof(nb_edges_));
+        write_bytes(&nb_graphs_, sizeof(nb_graphs_));
+        write_bytes(membership_sequence.data(),
+                nb_nodes*sizeof(unsigned int));
+        write_bytes(group_size_sequence.data(),
+                nb_groups*sizeof(unsigned int));
+        pad();
+    }
+    catch (runtime_error&)
+    {
+        fclose(file_);
+        throw;
+    }
+
+    node_offset_.push_back(0);
+    for (unsigned int membership : membership_sequence_)
+    {
+        node_offset_.push_back(node_offset_.back() + membership);
+    }
+}
+
+EnsembleWriter::~EnsembleWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (runtime_error&)
+    {
+        //nothing sensible to do in a destructor
+    }
+}
+
+void EnsembleWriter::write_bytes(const void* data, size_t size)
+{
+    if (fwrite(data, 1, size, file_) != size)
+    {
+        throw runtime_error("Cannot write ensemble file.");
+    }
+}
+
+//zero padding up to the next multiple of 8 bytes
+void EnsembleWriter::pad()
+{
+    const char zeros[8] = {0};
+    long position = ftell(file_);
+    write_bytes(zeros, align8(position) - position);
+}
+
+//sort the edges by node with a counting sort, then varint-encode the deltas
+//between consecutive groups of each node
+void EnsembleWriter::encode(const EdgeList& edge_list)
+{
+    node_cursor_.assign(node_offset_.begin(), node_offset_.end()-1);
+    sorted_groups_.resize(edge_list.size());
+    for (auto& edge : edge_list)
+    {
+        if (edge.first >= node_cursor_.size()
+                or node_cursor_[edge.first] == node_offset_[edge.first+1])
+        {
+            throw invalid_argument(
+                    "Edge list does not match the membership sequence.");
+        }
+        if (edge.second >= nb_groups_)
+        {
+            throw invalid_argument(
+                    "Edge list does not match the group size sequence.");
+        }
+        sorted_groups_[node_cursor_[edge.first]++] = edge.second;
+    }
+    payload_.clear();
+    for (size_t node = 0; node+1 < node_offset_.size(); node++)
+    {
+        auto first = sorted_groups_.begin() + node_offset_[node];
+        auto last = sorted_groups_.begin() + node_offset_[node+1];
+        sort(first, last);
+        Group previous = 0;
+        for (auto it = first; it != last; ++it)
+        {
+            write_varint(*it - previous, payload_);
+            previous = *it;
+        }
+    }
+}
+
+void EnsembleWriter::write(const EdgeList& edge_list)
+{
+    trace::Span span("ensemble_write");
+    if (file_ == nullptr)
+    {
+        throw runtime_error("Ensemble file is closed.");
+    }
+    if (edge_list.size() != nb_edges_)
+    {
+        throw invalid_argument(
+                "Edge list does not match the membership sequence.");
+    }
+    uint64_t payload_size;
+    if (compress_)
+    {
+        encode(edge_list);
+        payload_size = payload_.size();
+        write_bytes(&payload_size, sizeof(payload_size));
+        write_bytes(payload_.data(), payload_.size());
+    }
+    else
+    {
+        payload_size = edge_list.size()*sizeof(pair<Node,Group>);
+        write_bytes(&payload_size, sizeof(payload_size));
+        write_bytes(edge_list.data(), payload_size);
+    }
+    pad();
+    nb_graphs_ += 1;
+}
+
+void EnsembleWriter::write_random_graphs(
+        BipartiteConfigurationModelSampler& sampler, size_t nb_graphs,
+        unsigned int nb_steps)
+{
+    for (size_t i = 0; i < nb_graphs; i++)
+    {
+        write(sampler.get_random_graph(nb_steps));
+    }
+}
+
+void EnsembleWriter::close()
+{
+    if (file_ == nullptr)
+    {
+        return;
+    }
+    FILE* file = file_;
+    file_ = nullptr;
+    bool success = fseek(file, nb_graphs_offset_, SEEK_SET) == 0
+        and fwrite(&nb_graphs_, sizeof(nb_graphs_), 1, file) == 1;
+    success = (fclose(file) == 0) and success;
+    if (not success)
+    {
+        throw runtime_error("Cannot write ensemble file.");
+    }
+}
+
+/* =================
+ * EnsembleReader
+ * ================= */
+
+EnsembleReader::EnsembleReader(const string& path):
+    fd_(open(path.c_str(), O_RDONLY)),
+    data_(nullptr),
+    file_size_(0),
+    seed_(0),
+    nb_edges_(0),
+    compressed_(false),
+    membership_sequence_(),
+    group_size_sequence_(),
+    blocks_()
+{
+    if (fd_ < 0)
+    {
+        throw runtime_error("Cannot open " + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0
+            or size_t(file_stat.st_size) < SEQUENCES_OFFSET)
+    {
+        ::close(fd_);
+        throw runtime_error(path + " is not an ensemble file.");
+    }
+    file_size_ = file_stat.st_size;
+    void* data = mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED)
+    {
+        ::close(fd_);
+        throw runtime_error("Cannot map " + path);
+    }
+    data_ = static_cast<const unsigned char*>(data);
+
+    //from here the destructor does not run, so release on failure
+    try
+    {
+        if (memcmp(data_, ENSEMBLE_MAGIC, sizeof(ENSEMBLE_MAGIC)) != 0
+                or read_value<uint32_t>(data_+8) != ENSEMBLE_VERSION)
+        {
+            throw runtime_error(path + " is not an ensemble file.");
+        }
+        compressed_ = read_value<uint32_t>(data_+12) & ENSEMBLE_COMPRESSED;
+        seed_ = read_value<uint64_t>(data_+16);
+        uint64_t nb_nodes = read_value<uint64_t>(data_+24);
+        uint64_t nb_groups = read_value<uint64_t>(data_+32);
+        nb_edges_ = read_value<uint64_t>(data_+40);
+        //sizes are compared to the file before any product is formed
+        if (nb_nodes > file_size_ or nb_groups > file_size_
+                or SEQUENCES_OFFSET + (nb_nodes + nb_groups)
+                    *sizeof(unsigned int) > file_size_)
+        {
+            throw runtime_error(path + " is truncated.");
+        }
+        size_t offset = SEQUENCES_OFFSET
+            + (nb_nodes + nb_groups)*sizeof(unsigned int);
+        membership_sequence_.resize(nb_nodes);
+        memcpy(membership_sequence_.data(), data_+SEQUENCES_OFFSET,
+                nb_nodes*sizeof(unsigned int));
+        group_size_sequence_.resize(nb_groups);
+        memcpy(group_size_sequence_.data(),
+                data_+SEQUENCES_OFFSET+nb_nodes*sizeof(unsigned int),
+                nb_groups*sizeof(unsigned int));
+        //both sequences sum to the number of edges, which must fit in the
+        //address space as (node, group) pairs
+        if (accumulate(membership_sequence_.begin(),
+                    membership_sequence_.end(), uint64_t(0)) != nb_edges_
+                or accumulate(group_size_sequence_.begin(),
+                    group_size_sequence_.end(), uint64_t(0)) != nb_edges_
+                or nb_edges_ > numeric_limits<size_t>::max()
+                    /sizeof(pair<Node,Group>))
+        {
+            throw runtime_error(path + " is corrupted.");
+        }
+
+        //index the blocks; an incomplete last block (e.g. the writer is
+        //still running) is ignored
+        offset = align8(offset);
+        while (offset + sizeof(uint64_t) <= file_size_)
+        {
+            uint64_t payload_size = read_value<uint64_t>(data_+offset);
+            offset += sizeof(uint64_t);
+            if (payload_size > file_size_ - offset)
+            {
+                break;
+            }
+            //raw graphs are exactly nb_edges pairs, and each compressed
+            //edge takes at least one byte
+            if ((not compressed_
+                        and payload_size != nb_edges_*sizeof(pair<Node,Group>))
+                    or (compressed_ and payload_size < nb_edges_))
+            {
+                throw runtime_error(path + " is corrupted.");
+            }
+            blocks_.emplace_back(offset, payload_size);
+            offset = align8(offset + payload_size);
+        }
+    }
+    catch (runtime_error&)
+    {
+        munmap(const_cast<unsigned char*>(data_), file_size_);
+        ::close(fd_);
+        throw;
+    }
+}
+
+EnsembleReader::~EnsembleReader()
+{
+    munmap(const_cast<unsigned char*>(data_), file_size_);
+    ::close(fd_);
+}
+
+void EnsembleReader::check_index(size_t index) const
+{
+    if (index >= blocks_.size())
+    {
+        throw out_of_range("Graph index out of range.");
+    }
+}
+
+const uint32_t* EnsembleReader::raw_graph(size_t index) const
+{
+    check_index(index);
+    if (compressed_)
+    {
+        throw logic_error("Compressed graphs must be decoded.");
+    }
+    return reinterpret_cast<const uint32_t*>(data_ + blocks_[index].first);
+}
+
+void EnsembleReader::decode(size_t index, uint32_t* edges) const
+{
+    trace::Span span("ensemble_decode");
+    check_index(index);
+    const unsigned char* input = data_ + blocks_[index].first;
+    const unsigned char* end = input + blocks_[index].second;
+    if (not compressed_)
+    {
+        memcpy(edges, input, blocks_[index].second);
+        return;
+    }
+    uint64_t nb_decoded = 0;
+    for (Node node = 0; node < membership_sequence_.size(); node++)
+    {
+        Group group = 0;
+        for (unsigned int j = 0; j < membership_sequence_[node]; j++)
+        {
+            if (nb_decoded == nb_edges_)
+            {
+                throw runtime_error(
+                        "Corrupted compressed graph in ensemble file.");
+            }
+            uint64_t next_group = uint64_t(group) + read_varint(input, end);
+            if (next_group >= group_size_sequence_.size())
+            {
+                throw runtime_error(
+                        "Corrupted compressed graph in ensemble file.");
+            }
+            group = next_group;
+            edges[2*nb_decoded] = node;
+            edges[2*nb_decoded+1] = group;
+            nb_decoded += 1;
+        }
+    }
+    //every byte of the block belongs to the graph
+    if (nb_decoded != nb_edges_ or input != end)
+    {
+        throw runtime_error("Corrupted compressed graph in ensemble file.");
+    }
+}
+
+EdgeList EnsembleReader::get_graph(size_t index) const
+{
+    EdgeList edge_list(nb_edges_);
+    decode(index, reinterpret_cast<uint32_t*>(edge_list.data()));
+    return edge_list;
+}
+
+}//end of namespace horgg
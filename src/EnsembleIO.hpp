@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef ENSEMBLE_IO_HPP_
+#define ENSEMBLE_IO_HPP_
+
+#include "GraphGenerator.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Binary container for ensembles of bipartite graphs with the same sequences.
+ *
+ * Layout (native byte order, every section aligned on 8 bytes):
+ *   header   magic "HORGGENS", version, flags, seed, number of nodes, groups,
+ *            edges and graphs, then the membership and group size sequences
+ *   blocks   one per graph: payload size (uint64) followed by the payload
+ *
+ * A raw payload is the edge list as (node, group) uint32 pairs. A compressed
+ * payload stores the edges sorted by node then group; the nodes are implied
+ * by the membership sequence and the groups of each node are delta-encoded
+ * as LEB128 varints.
+ */
+
+const char ENSEMBLE_MAGIC[8] = {'H','O','R','G','G','E','N','S'};
+const std::uint32_t ENSEMBLE_VERSION = 1;
+const std::uint32_t ENSEMBLE_COMPRESSED = 1;
+
+//streaming writer -- graphs are appended one at a time
+class EnsembleWriter
+{
+public:
+    EnsembleWriter(const std::string& path,
+            const MembershipSequence& membership_sequence,
+            const GroupSizeSequence& group_size_sequence,
+            std::uint64_t seed, bool compress=true);
+    ~EnsembleWriter();
+
+    EnsembleWriter(const EnsembleWriter&) = delete;
+    EnsembleWriter& operator=(const EnsembleWriter&) = delete;
+
+    void write(const EdgeList& edge_list);
+
+    //append nb_graphs random graphs drawn with sampler.get_random_graph
+    void write_random_graphs(BipartiteConfigurationModelSampler& sampler,
+            std::size_t nb_graphs, unsigned int nb_steps=0);
+
+    //update the number of graphs in the header and close the file
+    void close();
+
+    std::uint64_t size() const {return nb_graphs_;}
+
+private:
+    std::FILE* file_;
+    bool compress_;
+    MembershipSequence membership_sequence_;
+    std::uint64_t nb_groups_;
+    std::uint64_t nb_edges_;
+    std::uint64_t nb_graphs_;
+    long nb_graphs_offset_;
+    //buffers reused between graphs
+    std::vector<std::uint32_t> node_offset_;
+    std::vector<std::uint32_t> node_cursor_;
+    std::vector<std::uint32_t> sorted_groups_;
+    std::vector<unsigned char> payload_;
+
+    void write_bytes(const void* data, std::size_t size);
+    void pad();
+    void encode(const EdgeList& edge_list);
+};
+
+//read-only access to an ensemble file through a memory map
+class EnsembleReader
+{
+public:
+    explicit EnsembleReader(const std::string& path);
+    ~EnsembleReader();
+
+    EnsembleReader(const EnsembleReader&) = delete;
+    EnsembleReader& operator=(const EnsembleReader&) = delete;
+
+    std::size_t size() const {return blocks_.size();}
+    std::uint64_t get_seed() const {return seed_;}
+    std::uint64_t get_nb_edges() const {return nb_edges_;}
+    bool is_compressed() const {return compressed_;}
+    const MembershipSequence& get_membership_sequence() const
+        {return membership_sequence_;}
+    const GroupSizeSequence& get_group_size_sequence() const
+        {return group_size_sequence_;}
+
+    //pointer to the (node, group) pairs of a raw graph, inside the mapping
+    const std::uint32_t* raw_graph(std::size_t index) const;
+
+    //decode graph `index` into `edges` as nb_edges (node, group) pairs
+    void decode(std::size_t index, std::uint32_t* edges) const;
+
+    EdgeList get_graph(std::size_t index) const;
+
+private:
+    int fd_;
+    const unsigned char* data_;
+    std::size_t file_size_;
+    std::uint64_t seed_;
+    std::uint64_t nb_edges_;
+    bool compressed_;
+    MembershipSequence membership_sequence_;
+    GroupSizeSequence group_size_sequence_;
+    //offset and size of each payload
+    std::vector<std::pair<std::size_t, std::size_t> > blocks_;
+
+    void check_index(std::size_t index) const;
+};
+
+}//end of namespace horgg
+
+#endif /* ENSEMBLE_IO_HPP_ */
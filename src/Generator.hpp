@@ -0,0 +1,279 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef GENERATOR_HPP_
+#define GENERATOR_HPP_
+
+/*
+ * Coroutine interface (C++20) to pull samples one at a time:
+ *
+ *   for (EdgeListView graph : thinned_samples(sampler, 1000, 10000))
+ *   {
+ *       ...
+ *   }
+ *
+ * The views point to the state of the sampler or to a buffer reused between
+ * samples, so no sample is copied or allocated; a view is only valid until
+ * the generator is resumed. The header is empty for older standards.
+ */
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include "GraphGenerator.hpp"
+#include "EnsembleIO.hpp"
+#include "SharedEnsemble.hpp"
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+//non-owning view on the edges of a graph, stored either as contiguous
+//(node, group) pairs or as interleaved node and group uint32 words
+class EdgeListView
+{
+public:
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::pair<Node,Group> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef value_type reference;
+
+        const_iterator(): view_(nullptr), index_(0) {}
+        const_iterator(const EdgeListView* view, std::size_t index):
+            view_(view), index_(index) {}
+        value_type operator*() const {return (*view_)[index_];}
+        const_iterator& operator++()
+        {
+            index_++;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator previous(*this);
+            index_++;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const
+            {return index_ == other.index_;}
+        bool operator!=(const const_iterator& other) const
+            {return index_ != other.index_;}
+
+    private:
+        const EdgeListView* view_;
+        std::size_t index_;
+    };
+
+    EdgeListView(): pairs_(nullptr), words_(nullptr), size_(0) {}
+    EdgeListView(const std::pair<Node,Group>* data, std::size_t size):
+        pairs_(data), words_(nullptr), size_(size) {}
+    EdgeListView(const std::uint32_t* words, std::size_t size):
+        pairs_(nullptr), words_(words), size_(size) {}
+    EdgeListView(const EdgeList& edge_list):
+        pairs_(edge_list.data()), words_(nullptr), size_(edge_list.size()) {}
+
+    const_iterator begin() const {return const_iterator(this, 0);}
+    const_iterator end() const {return const_iterator(this, size_);}
+    std::size_t size() const {return size_;}
+    std::pair<Node,Group> operator[](std::size_t i) const
+    {
+        if (pairs_)
+        {
+            return pairs_[i];
+        }
+        return std::make_pair(Node(words_[2*i]), Group(words_[2*i+1]));
+    }
+    EdgeList copy() const {return EdgeList(begin(), end());}
+
+private:
+    const std::pair<Node,Group>* pairs_;
+    const std::uint32_t* words_;
+    std::size_t size_;
+};
+
+//lazy sequence of values produced by a coroutine, traversed once
+template <typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        const T* value;
+        std::exception_ptr error;
+
+        Generator get_return_object()
+        {
+            return Generator(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {return {};}
+        std::suspend_always final_suspend() noexcept {return {};}
+        //the value lives in the coroutine frame while it is suspended
+        std::suspend_always yield_value(const T& yielded) noexcept
+        {
+            value = &yielded;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() {error = std::current_exception();}
+    };
+
+    class iterator
+    {
+    public:
+        explicit iterator(std::coroutine_handle<promise_type> handle):
+            handle_(handle) {}
+        const T& operator*() const {return *handle_.promise().value;}
+        const T* operator->() const {return handle_.promise().value;}
+        iterator& operator++()
+        {
+            resume(handle_);
+            return *this;
+        }
+        bool operator==(std::default_sentinel_t) const
+            {return handle_.done();}
+        bool operator!=(std::default_sentinel_t) const
+            {return not handle_.done();}
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    Generator(Generator&& other) noexcept:
+        handle_(std::exchange(other.handle_, nullptr)) {}
+    Generator& operator=(Generator&& other) noexcept
+    {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    iterator begin()
+    {
+        resume(handle_);
+        return iterator(handle_);
+    }
+    std::default_sentinel_t end() const {return {};}
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit Generator(std::coroutine_handle<promise_type> handle):
+        handle_(handle) {}
+
+    static void resume(std::coroutine_handle<promise_type> handle)
+    {
+        handle.resume();
+        if (handle.promise().error)
+        {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+};
+
+//successive states of the current chain of the sampler, nb_steps swaps
+//apart; the views point to the graph of the sampler
+inline Generator<EdgeListView> thinned_samples(
+        BipartiteConfigurationModelSampler& sampler, std::size_t nb_samples,
+        unsigned int nb_steps)
+{
+    for (std::size_t i = 0; i < nb_samples; i++)
+    {
+        for (unsigned int j = 0; j < nb_steps; j++)
+        {
+            sampler.mcmc_step();
+        }
+        co_yield EdgeListView(sampler.get_graph());
+    }
+}
+
+//independent graphs drawn with sampler.get_random_graph
+inline Generator<EdgeListView> random_graphs(
+        BipartiteConfigurationModelSampler& sampler, std::size_t nb_graphs,
+        unsigned int nb_steps=0)
+{
+    for (std::size_t i = 0; i < nb_graphs; i++)
+    {
+        co_yield EdgeListView(sampler.get_random_graph(nb_steps));
+    }
+}
+
+//graphs of an ensemble file: views on the mapping for raw files, or on a
+//single buffer in which compressed graphs are decoded
+inline Generator<EdgeListView> ensemble_samples(const EnsembleReader& reader)
+{
+    std::vector<std::uint32_t> buffer(
+            reader.is_compressed() ? 2*reader.get_nb_edges() : 0);
+    for (std::size_t i = 0; i < reader.size(); i++)
+    {
+        const std::uint32_t* words = buffer.data();
+        if (reader.is_compressed())
+        {
+            reader.decode(i, buffer.data());
+        }
+        else
+        {
+            words = reader.raw_graph(i);
+        }
+        co_yield EdgeListView(words, reader.get_nb_edges());
+    }
+}
+
+//graphs of a shared-memory ensemble, waiting for the writer up to timeout
+//for each of the capacity graphs
+inline Generator<EdgeListView> ensemble_samples(
+        const SharedEnsembleReader& reader, Clock::duration timeout)
+{
+    for (std::size_t i = 0; i < reader.get_capacity(); i++)
+    {
+        if (reader.wait(i+1, timeout) <= i)
+        {
+            co_return;
+        }
+        co_yield EdgeListView(reader.raw_graph(i), reader.get_nb_edges());
+    }
+}
+
+}//end of namespace horgg
+
+#endif
+
+#endif /* GENERATOR_HPP_ */
@@ -23,7 +23,11 @@
  */
 
 #include "GraphGenerator.hpp"
+#include "Incidence.hpp"
+#include "Trace.hpp"
 #include <algorithm>
+#include <cstring>
+#include <sstream>
 #include <time.h>
 
 using namespace std;
@@ -36,11 +40,13 @@ namespace horgg
  * ================= */
 //initialize RNG
 
-RNGType BaseGenerator::gen_ = RNGType(time(NULL));
+unsigned int BaseGenerator::seed_value_ = time(NULL);
+RNGType BaseGenerator::gen_ = RNGType(BaseGenerator::seed_value_);
 
 //method to seed the RNG
 void BaseGenerator::seed(unsigned int seed_value)
 {
+    BaseGenerator::seed_value_ = seed_value;
     BaseGenerator::gen_.seed(seed_value);
 }
 
@@ -56,10 +62,79 @@ BipartiteConfigurationModelSampler::BipartiteConfigurationModelSampler(
     largest_group_label_(group_size_sequence.size()-1),
     largest_node_label_(membership_sequence.size()-1),
     edge_list_(),
-    edge_set_()
+    edge_set_(),
+    observers_(),
+    local_rng_(false),
+    local_gen_(),
+    incidence_csr_(),
+    incidence_csc_(),
+    frozen_(),
+    node_classes_(),
+    group_classes_(),
+    mobile_edges_(),
+    buckets_(),
+    edge_bucket_(),
+    largest_bucket_size_(0)
+{
+    initialize(membership_sequence,group_size_sequence);
+}
+
+//Constructor using membership and group size sequences, with its own RNG
+BipartiteConfigurationModelSampler::BipartiteConfigurationModelSampler(
+        const MembershipSequence& membership_sequence,
+        const GroupSizeSequence& group_size_sequence,
+        const RNGType& gen):
+    group_stub_vector_(),node_stub_vector_(),
+    largest_group_label_(group_size_sequence.size()-1),
+    largest_node_label_(membership_sequence.size()-1),
+    edge_list_(),
+    edge_set_(),
+    observers_(),
+    local_rng_(true),
+    local_gen_(gen),
+    incidence_csr_(),
+    incidence_csc_(),
+    frozen_(),
+    node_classes_(),
+    group_classes_(),
+    mobile_edges_(),
+    buckets_(),
+    edge_bucket_(),
+    largest_bucket_size_(0)
+{
+    initialize(membership_sequence,group_size_sequence);
+}
+
+//empty sampler, filled by load_state
+BipartiteConfigurationModelSampler::BipartiteConfigurationModelSampler():
+    group_stub_vector_(),node_stub_vector_(),
+    largest_group_label_(0),
+    largest_node_label_(0),
+    edge_list_(),
+    edge_set_(),
+    observers_(),
+    local_rng_(false),
+    local_gen_(),
+    incidence_csr_(),
+    incidence_csc_(),
+    frozen_(),
+    node_classes_(),
+    group_classes_(),
+    mobile_edges_(),
+    buckets_(),
+    edge_bucket_(),
+    largest_bucket_size_(0)
+{
+}
+
+//check the sequences, build the stub vectors and make a first stub matching
+void BipartiteConfigurationModelSampler::initialize(
+        const MembershipSequence& membership_sequence,
+        const GroupSizeSequence& group_size_sequence)
 {
     try
     {
+        trace::Span span("is_bigraphic");
         is_bigraphic(membership_sequence,group_size_sequence);
     }
     catch (invalid_argument& e)
@@ -68,18 +143,21 @@ BipartiteConfigurationModelSampler::BipartiteConfigurationModelSampler(
     }
 
     //initialize group and node stub vectors
-    for (Node i = 0; i < membership_sequence.size(); i++)
     {
-        for (int j = 0; j < membership_sequence[i]; j++)
+        trace::Span span("stub_expansion");
+        for (Node i = 0; i < membership_sequence.size(); i++)
         {
-            node_stub_vector_.push_back(i);
+            for (int j = 0; j < membership_sequence[i]; j++)
+            {
+                node_stub_vector_.push_back(i);
+            }
         }
-    }
-    for (Group i = 0; i < group_size_sequence.size(); i++)
-    {
-        for (int j = 0; j < group_size_sequence[i]; j++)
+        for (Group i = 0; i < group_size_sequence.size(); i++)
         {
-            group_stub_vector_.push_back(i);
+            for (int j = 0; j < group_size_sequence[i]; j++)
+            {
+                group_stub_vector_.push_back(i);
+            }
         }
     }
 
@@ -95,7 +173,19 @@ BipartiteConfigurationModelSampler::BipartiteConfigurationModelSampler(
     largest_group_label_(0),
     largest_node_label_(0),
     edge_list_(edge_list),
-    edge_set_(edge_list_.begin(),edge_list_.end())
+    edge_set_(edge_list_.begin(),edge_list_.end()),
+    observers_(),
+    local_rng_(false),
+    local_gen_(),
+    incidence_csr_(),
+    incidence_csc_(),
+    frozen_(),
+    node_classes_(),
+    group_classes_(),
+    mobile_edges_(),
+    buckets_(),
+    edge_bucket_(),
+    largest_bucket_size_(0)
 {
     //determine largest labels and initialize node and group stub vector
     for (auto& edge : edge_list_)
@@ -116,75 +206,407 @@ BipartiteConfigurationModelSampler::BipartiteConfigurationModelSampler(
 }
 
 
-//make the edge list the result of a stub matching
-void BipartiteConfigurationModelSampler::stub_matching()
+//Constructor using an edge list and the edges that are never moved
+BipartiteConfigurationModelSampler::BipartiteConfigurationModelSampler(
+        const EdgeList& edge_list, const vector<uint8_t>& frozen):
+    BipartiteConfigurationModelSampler(edge_list)
+{
+    set_frozen_edges(frozen);
+}
+
+void BipartiteConfigurationModelSampler::set_frozen_edges(
+        const vector<uint8_t>& frozen)
+{
+    if (not frozen.empty() and frozen.size() != edge_list_.size())
+    {
+        throw invalid_argument("The mask must have one entry per edge.");
+    }
+    frozen_ = frozen;
+    build_buckets();
+}
+
+void BipartiteConfigurationModelSampler::set_classes(
+        const vector<unsigned int>& node_classes,
+        const vector<unsigned int>& group_classes)
+{
+    if (not node_classes.empty() and node_classes.size() != get_nb_nodes())
+    {
+        throw invalid_argument("There must be one class per node.");
+    }
+    if (not group_classes.empty() and group_classes.size() != get_nb_groups())
+    {
+        throw invalid_argument("There must be one class per group.");
+    }
+    node_classes_ = node_classes;
+    group_classes_ = group_classes;
+    build_buckets();
+}
+
+//the bucket of an edge never changes: swaps keep the node of each edge and
+//exchange groups of the same class
+void BipartiteConfigurationModelSampler::build_buckets()
+{
+    mobile_edges_.clear();
+    buckets_.clear();
+    edge_bucket_.clear();
+    largest_bucket_size_ = 0;
+    if (frozen_.empty() and node_classes_.empty() and group_classes_.empty())
+    {
+        return;
+    }
+
+    unordered_map<pair<unsigned int,unsigned int>, unsigned int> bucket_index;
+    edge_bucket_.assign(edge_list_.size(), 0);
+    for (size_t edge = 0; edge < edge_list_.size(); edge++)
+    {
+        if (not frozen_.empty() and frozen_[edge])
+        {
+            continue;
+        }
+        mobile_edges_.push_back(edge);
+        Node node = edge_list_[edge].first;
+        Group group = edge_list_[edge].second;
+        pair<unsigned int,unsigned int> classes(
+                node_classes_.empty() ? 0 : node_classes_[node],
+                group_classes_.empty() ? 0 : group_classes_[group]);
+        auto it = bucket_index.emplace(classes, buckets_.size()).first;
+        if (it->second == buckets_.size())
+        {
+            buckets_.emplace_back();
+        }
+        buckets_[it->second].push_back(edge);
+        edge_bucket_[edge] = it->second;
+    }
+    for (auto& bucket : buckets_)
+    {
+        largest_bucket_size_ = max(largest_bucket_size_, bucket.size());
+    }
+}
+
+//number of groups of each node
+MembershipSequence
+BipartiteConfigurationModelSampler::get_membership_sequence() const
+{
+    MembershipSequence membership_sequence(largest_node_label_+1, 0);
+    for (Node node : node_stub_vector_)
+    {
+        membership_sequence[node] += 1;
+    }
+    return membership_sequence;
+}
+
+//number of nodes in each group
+GroupSizeSequence
+BipartiteConfigurationModelSampler::get_group_size_sequence() const
+{
+    GroupSizeSequence group_size_sequence(largest_group_label_+1, 0);
+    for (Group group : group_stub_vector_)
+    {
+        group_size_sequence[group] += 1;
+    }
+    return group_size_sequence;
+}
+
+const CompressedRows& BipartiteConfigurationModelSampler::get_incidence_csr()
+{
+    build_incidence(edge_list_, get_nb_nodes(), get_nb_groups(), true,
+            incidence_csr_);
+    return incidence_csr_;
+}
+
+const CompressedRows& BipartiteConfigurationModelSampler::get_incidence_csc()
+{
+    build_incidence(edge_list_, get_nb_nodes(), get_nb_groups(), false,
+            incidence_csc_);
+    return incidence_csc_;
+}
+
+namespace
+{//start of anonymous namespace
+
+void check_deadline(Clock::time_point deadline)
+{
+    if (Clock::now() > deadline)
+    {
+        throw runtime_error("Stub matching did not finish before the deadline");
+    }
+}
+
+//std::shuffle without deadline, so that the graphs drawn for a seed do not
+//change; otherwise Fisher-Yates with the clock read every interval draws
+template <typename T>
+void shuffle_before(vector<T>& values, RNGType& gen,
+        Clock::time_point deadline)
+{
+    if (deadline == Clock::time_point::max())
+    {
+        shuffle(values.begin(), values.end(), gen);
+        return;
+    }
+    for (size_t i = values.size(); i > 1; i--)
+    {
+        if (i % BipartiteConfigurationModelSampler::DEADLINE_CHECK_INTERVAL
+                == 0)
+        {
+            check_deadline(deadline);
+        }
+        swap(values[i-1], values[random_int(i, gen)]);
+    }
+}
+
+}//end of anonymous namespace
+
+//make the edge list the result of a stub matching; the new graph is built
+//aside and only replaces the current one if the deadline is met
+void BipartiteConfigurationModelSampler::stub_matching(
+        Clock::time_point deadline)
+{
+    EdgeList edge_list;
+    EdgeSet edge_set;
+    if (not buckets_.empty())
+    {
+        bucketed_stub_matching(deadline, edge_list, edge_set);
+    }
+    else
+    {
+        unbucketed_stub_matching(deadline, edge_list, edge_set);
+    }
+    edge_list_.swap(edge_list);
+    edge_set_.swap(edge_set);
+
+    for (SwapObserver* observer : observers_)
+    {
+        observer->on_reset(edge_list_);
+    }
+}
+
+void BipartiteConfigurationModelSampler::unbucketed_stub_matching(
+        Clock::time_point deadline, EdgeList& edge_list, EdgeSet& edge_set)
 {
     //shuffle the stub vectors and get a new edge list
-    shuffle(group_stub_vector_.begin(),group_stub_vector_.end(),gen_);
-    shuffle(node_stub_vector_.begin(),node_stub_vector_.end(),gen_);
-    edge_list_ = EdgeList();
-    for (int i = 0; i < node_stub_vector_.size(); i++)
     {
-        edge_list_.push_back(make_pair(node_stub_vector_[i],
-                    group_stub_vector_[i]));
+        trace::Span span("shuffle");
+        shuffle_before(group_stub_vector_, rng(), deadline);
+        shuffle_before(node_stub_vector_, rng(), deadline);
+        edge_list.reserve(node_stub_vector_.size());
+        for (int i = 0; i < node_stub_vector_.size(); i++)
+        {
+            edge_list.push_back(make_pair(node_stub_vector_[i],
+                        group_stub_vector_[i]));
+        }
     }
 
     // Check for repeated edges -- rewire them
-    bool faulty_links = true;
-    while (faulty_links)
     {
-        faulty_links = false;
-        sort(edge_list_.begin(),edge_list_.end());
-        for (size_t edge1=0; edge1<edge_list_.size(); edge1++)
+        trace::Span span("repair");
+        bool faulty_links = true;
+        while (faulty_links)
         {
-            // If the link is faulty, rewire the stubs
-            if (edge_list_[edge1] == edge_list_[(edge1+1)% edge_list_.size()])
+            check_deadline(deadline);
+            faulty_links = false;
+            sort(edge_list.begin(),edge_list.end());
+            for (size_t edge1=0; edge1<edge_list.size(); edge1++)
             {
-                faulty_links = true;
-                Node node1 = edge_list_[edge1].first;
-                Group group1 = edge_list_[edge1].second;
-                unsigned int edge2 = random_int(edge_list_.size(), gen_);
-                Node node2 = edge_list_[edge2].first;
-                Group group2 = edge_list_[edge2].second;
-                // Switch stubs
-                edge_list_[edge1].second = group2;
-                edge_list_[edge2].second = group1;
+                if (edge1 % DEADLINE_CHECK_INTERVAL == 0)
+                {
+                    check_deadline(deadline);
+                }
+                // If the link is faulty, rewire the stubs
+                if (edge_list[edge1] ==
+                        edge_list[(edge1+1)% edge_list.size()])
+                {
+                    faulty_links = true;
+                    Group group1 = edge_list[edge1].second;
+                    unsigned int edge2 = random_int(edge_list.size(), rng());
+                    Group group2 = edge_list[edge2].second;
+                    // Switch stubs
+                    edge_list[edge1].second = group2;
+                    edge_list[edge2].second = group1;
+                }
             }
         }
     }
 
-    edge_set_ = EdgeSet(edge_list_.begin(),edge_list_.end());
+    {
+        trace::Span span("edge_set");
+        edge_set = EdgeSet(edge_list.size());
+        for (size_t edge = 0; edge < edge_list.size(); edge++)
+        {
+            if (edge % DEADLINE_CHECK_INTERVAL == 0)
+            {
+                check_deadline(deadline);
+            }
+            edge_set.insert(edge_list[edge]);
+        }
+    }
 }
 
-void BipartiteConfigurationModelSampler::mcmc_step()
+//rematch the groups within each bucket, keeping every edge at its index
+void BipartiteConfigurationModelSampler::bucketed_stub_matching(
+        Clock::time_point deadline, EdgeList& edge_list, EdgeSet& edge_set)
 {
-    bool same_edge = true;
-    while (same_edge)
+    edge_list = edge_list_;
     {
-        unsigned int edge1 = random_int(edge_list_.size(), gen_);
-        unsigned int edge2 = random_int(edge_list_.size(), gen_);
-        if (edge1 != edge2)
+        trace::Span span("shuffle");
+        for (auto& bucket : buckets_)
         {
-            same_edge = false;
-            Node node1 = edge_list_[edge1].first;
-            Node node2 = edge_list_[edge2].first;
-            Group group1 = edge_list_[edge1].second;
-            Group group2 = edge_list_[edge2].second;
-            if (edge_set_.count(make_pair(node1,group2)) == 0
-                    and edge_set_.count(make_pair(node2,group1)) == 0)
+            for (size_t i = bucket.size(); i > 1; i--)
             {
-                // Switch stubs
-                edge_list_[edge1].second = group2;
-                edge_list_[edge2].second = group1;
-                //remove old edges and add new ones
-                edge_set_.erase(make_pair(node1,group1));
-                edge_set_.erase(make_pair(node2,group2));
-                edge_set_.insert(make_pair(node1,group2));
-                edge_set_.insert(make_pair(node2,group1));
+                if (i % DEADLINE_CHECK_INTERVAL == 0)
+                {
+                    check_deadline(deadline);
+                }
+                size_t j = random_int(i, rng());
+                swap(edge_list[bucket[i-1]].second,
+                        edge_list[bucket[j]].second);
             }
-            //otherwise do nothing (the move is rejected)
         }
     }
+
+    //the frozen edges are simple, so only mobile edges can be repeated;
+    //exchange the groups of repeated edges with random edges of their bucket
+    trace::Span span("repair");
+    vector<unsigned int> faulty_edges;
+    do
+    {
+        check_deadline(deadline);
+        for (unsigned int edge : faulty_edges)
+        {
+            const vector<unsigned int>& bucket = buckets_[edge_bucket_[edge]];
+            unsigned int other = bucket[random_int(bucket.size(), rng())];
+            swap(edge_list[edge].second, edge_list[other].second);
+        }
+        faulty_edges.clear();
+        edge_set = EdgeSet(edge_list.size());
+        for (size_t edge = 0; edge < frozen_.size(); edge++)
+        {
+            if (frozen_[edge])
+            {
+                edge_set.insert(edge_list[edge]);
+            }
+        }
+        for (size_t i = 0; i < mobile_edges_.size(); i++)
+        {
+            if (i % DEADLINE_CHECK_INTERVAL == 0)
+            {
+                check_deadline(deadline);
+            }
+            unsigned int edge = mobile_edges_[i];
+            if (not edge_set.insert(edge_list[edge]).second)
+            {
+                faulty_edges.push_back(edge);
+            }
+        }
+    }
+    while (not faulty_edges.empty());
+}
+
+void BipartiteConfigurationModelSampler::mcmc_step()
+{
+    if (not can_swap())
+    {
+        return;
+    }
+    unsigned int edge1;
+    unsigned int edge2;
+    if (propose_swap(edge1, edge2))
+    {
+        apply_swap(edge1, edge2);
+    }
+    //otherwise do nothing (the move is rejected)
+}
+
+bool BipartiteConfigurationModelSampler::can_swap() const
+{
+    return get_nb_mobile_edges() >= 2
+        and (buckets_.empty() or largest_bucket_size_ >= 2);
+}
+
+bool BipartiteConfigurationModelSampler::propose_swap(unsigned int& edge1,
+        unsigned int& edge2)
+{
+    size_t nb_mobile_edges = get_nb_mobile_edges();
+    do
+    {
+        edge1 = random_int(nb_mobile_edges, rng());
+        if (buckets_.empty())
+        {
+            edge2 = random_int(nb_mobile_edges, rng());
+        }
+        else
+        {
+            edge1 = mobile_edges_[edge1];
+            const vector<unsigned int>& bucket = buckets_[edge_bucket_[edge1]];
+            edge2 = bucket[random_int(bucket.size(), rng())];
+        }
+    } while (edge1 == edge2);
+    Node node1 = edge_list_[edge1].first;
+    Node node2 = edge_list_[edge2].first;
+    Group group1 = edge_list_[edge1].second;
+    Group group2 = edge_list_[edge2].second;
+    return edge_set_.count(make_pair(node1,group2)) == 0
+        and edge_set_.count(make_pair(node2,group1)) == 0;
+}
+
+void BipartiteConfigurationModelSampler::apply_swap(unsigned int edge1,
+        unsigned int edge2)
+{
+    Node node1 = edge_list_[edge1].first;
+    Node node2 = edge_list_[edge2].first;
+    Group group1 = edge_list_[edge1].second;
+    Group group2 = edge_list_[edge2].second;
+    // Switch stubs
+    edge_list_[edge1].second = group2;
+    edge_list_[edge2].second = group1;
+    //remove old edges and add new ones
+    edge_set_.erase(make_pair(node1,group1));
+    edge_set_.erase(make_pair(node2,group2));
+    edge_set_.insert(make_pair(node1,group2));
+    edge_set_.insert(make_pair(node2,group1));
+    for (SwapObserver* observer : observers_)
+    {
+        observer->on_swap(edge1,edge2,node1,group1,node2,group2);
+    }
+}
+
+unsigned long long BipartiteConfigurationModelSampler::draw_seed()
+{
+    unsigned long long high = rng()();
+    return (high << 32) | rng()();
+}
+
+double BipartiteConfigurationModelSampler::draw_uniform()
+{
+    return generate_canonical<double, numeric_limits<double>::digits>(rng());
+}
+
+//use a RNG owned by the sampler instead of the shared one
+void BipartiteConfigurationModelSampler::use_local_rng(
+        unsigned long long seed_value, unsigned long long stream)
+{
+    local_rng_ = true;
+    local_gen_ = RNGType(seed_value,stream);
+}
+
+void BipartiteConfigurationModelSampler::attach(SwapObserver* observer)
+{
+    observers_.push_back(observer);
+    try
+    {
+        observer->on_reset(edge_list_);
+    }
+    catch (...)
+    {
+        //the observer may be an object under construction
+        observers_.pop_back();
+        throw;
+    }
+}
+
+void BipartiteConfigurationModelSampler::detach(SwapObserver* observer)
+{
+    observers_.erase(remove(observers_.begin(),observers_.end(),observer),
+            observers_.end());
 }
 
 //generate a random bipartite graph -- uses stub matching + mcmc
@@ -195,6 +617,7 @@ const EdgeList& BipartiteConfigurationModelSampler::get_random_graph(
     stub_matching();
 
     //perform additional mcmc steps to ensure uniformity
+    trace::Span span("mcmc");
     for(int i = 0; i < nb_steps; i++)
     {
         mcmc_step();
@@ -203,6 +626,248 @@ const EdgeList& BipartiteConfigurationModelSampler::get_random_graph(
     return edge_list_;
 }
 
+size_t BipartiteConfigurationModelSampler::get_random_graph_within(
+        Clock::duration budget)
+{
+    Clock::time_point deadline = Clock::now() + budget;
+    stub_matching(deadline);
+
+    //batches of swaps between two clock reads are sized from the measured
+    //time per swap to use about half of the remaining budget, so that the
+    //overshoot is at most a few swaps
+    trace::Span span("mcmc");
+    size_t nb_steps = 0;
+    size_t batch_size = MIN_DEADLINE_BATCH;
+    Clock::time_point now = Clock::now();
+    while (now < deadline)
+    {
+        for (size_t i = 0; i < batch_size; i++)
+        {
+            mcmc_step();
+        }
+        nb_steps += batch_size;
+        Clock::time_point last = now;
+        now = Clock::now();
+        double time_per_step = chrono::duration<double>(now - last).count()
+            /batch_size;
+        double remaining = chrono::duration<double>(deadline - now).count();
+        batch_size = DEADLINE_CHECK_INTERVAL;
+        if (remaining < time_per_step*2*DEADLINE_CHECK_INTERVAL)
+        {
+            batch_size = max(remaining/(2*time_per_step), 1.);
+        }
+    }
+    return nb_steps;
+}
+
+namespace
+{//start of anonymous namespace
+
+const char SAMPLER_STATE_MAGIC[8] = {'H','O','R','G','G','S','M','P'};
+const uint32_t SAMPLER_STATE_VERSION = 4;
+//version 2 has no frozen edges and version 3 no classes
+const uint32_t MIN_SAMPLER_STATE_VERSION = 2;
+
+template <typename T>
+void write_value(ostream& output, const T& value)
+{
+    output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void read_value(istream& input, T& value)
+{
+    if (not input.read(reinterpret_cast<char*>(&value), sizeof(T)))
+    {
+        throw runtime_error("Truncated sampler state.");
+    }
+}
+
+//array preceded by its size
+template <typename T>
+void write_vector(ostream& output, const vector<T>& values)
+{
+    write_value(output, uint64_t(values.size()));
+    output.write(reinterpret_cast<const char*>(values.data()),
+            values.size()*sizeof(T));
+}
+
+template <typename T>
+void read_vector(istream& input, vector<T>& values, uint64_t max_size)
+{
+    uint64_t size;
+    read_value(input, size);
+    if (size > max_size)
+    {
+        throw runtime_error("Corrupted sampler state.");
+    }
+    values.resize(size);
+    if (not input.read(reinterpret_cast<char*>(values.data()),
+                size*sizeof(T)))
+    {
+        throw runtime_error("Truncated sampler state.");
+    }
+}
+
+//version of a state header, checked against the supported range
+uint32_t state_version(const string& header)
+{
+    istringstream input(header);
+    char magic[sizeof(SAMPLER_STATE_MAGIC)];
+    uint32_t version;
+    if (not input.read(magic, sizeof(magic))
+            or memcmp(magic, SAMPLER_STATE_MAGIC, sizeof(magic)) != 0)
+    {
+        throw runtime_error("Not a sampler state.");
+    }
+    read_value(input, version);
+    if (version < MIN_SAMPLER_STATE_VERSION
+            or version > SAMPLER_STATE_VERSION)
+    {
+        throw runtime_error("Unsupported sampler state version.");
+    }
+    return version;
+}
+
+}//end of anonymous namespace
+
+//magic, version, labels and RNG (text representation of pcg)
+string BipartiteConfigurationModelSampler::get_state_header() const
+{
+    ostringstream header;
+    header.write(SAMPLER_STATE_MAGIC, sizeof(SAMPLER_STATE_MAGIC));
+    write_value(header, SAMPLER_STATE_VERSION);
+    write_value(header, uint32_t(largest_node_label_));
+    write_value(header, uint32_t(largest_group_label_));
+    write_value(header, uint8_t(local_rng_));
+    write_value(header, uint32_t(seed_value_));
+    header << (local_rng_ ? local_gen_ : gen_);
+    return header.str();
+}
+
+//header block, stub vectors and edge list
+void BipartiteConfigurationModelSampler::save_state(ostream& output) const
+{
+    string header = get_state_header();
+    write_vector(output, vector<char>(header.begin(), header.end()));
+    write_vector(output, node_stub_vector_);
+    write_vector(output, group_stub_vector_);
+    write_vector(output, edge_list_);
+    write_vector(output, frozen_);
+    write_vector(output, node_classes_);
+    write_vector(output, group_classes_);
+    if (not output)
+    {
+        throw runtime_error("Cannot write sampler state.");
+    }
+}
+
+BipartiteConfigurationModelSampler
+BipartiteConfigurationModelSampler::load_state(istream& input)
+{
+    const uint64_t max_size = numeric_limits<uint32_t>::max();
+    vector<char> header;
+    vector<Node> node_stub_vector;
+    vector<Group> group_stub_vector;
+    EdgeList edge_list;
+    vector<uint8_t> frozen;
+    vector<unsigned int> node_classes;
+    vector<unsigned int> group_classes;
+    read_vector(input, header, 1024);
+    uint32_t version = state_version(string(header.begin(), header.end()));
+    read_vector(input, node_stub_vector, max_size);
+    read_vector(input, group_stub_vector, max_size);
+    read_vector(input, edge_list, max_size);
+    if (version >= 3)
+    {
+        read_vector(input, frozen, max_size);
+    }
+    if (version >= 4)
+    {
+        read_vector(input, node_classes, max_size);
+        read_vector(input, group_classes, max_size);
+    }
+    return from_state(string(header.begin(), header.end()), move(edge_list),
+            move(node_stub_vector), move(group_stub_vector), move(frozen),
+            move(node_classes), move(group_classes));
+}
+
+BipartiteConfigurationModelSampler
+BipartiteConfigurationModelSampler::from_state(const string& header,
+        EdgeList&& edge_list, vector<Node>&& node_stub_vector,
+        vector<Group>&& group_stub_vector, vector<uint8_t>&& frozen,
+        vector<unsigned int>&& node_classes,
+        vector<unsigned int>&& group_classes)
+{
+    trace::Span span("load_state");
+    uint32_t version = state_version(header);
+    istringstream input(header);
+    input.seekg(sizeof(SAMPLER_STATE_MAGIC) + sizeof(version));
+    if ((version < 3 and not frozen.empty())
+            or (version < 4 and not (node_classes.empty()
+                    and group_classes.empty())))
+    {
+        throw runtime_error("Corrupted sampler state.");
+    }
+
+    BipartiteConfigurationModelSampler sampler;
+    uint32_t largest_node_label, largest_group_label, seed_value;
+    uint8_t local_rng;
+    RNGType gen;
+    read_value(input, largest_node_label);
+    read_value(input, largest_group_label);
+    read_value(input, local_rng);
+    read_value(input, seed_value);
+    if (not (input >> gen))
+    {
+        throw runtime_error("Corrupted sampler state.");
+    }
+    sampler.largest_node_label_ = largest_node_label;
+    sampler.largest_group_label_ = largest_group_label;
+
+    size_t nb_edges = edge_list.size();
+    if (node_stub_vector.size() != nb_edges
+            or group_stub_vector.size() != nb_edges
+            or (not frozen.empty() and frozen.size() != nb_edges)
+            or (not node_classes.empty()
+                and node_classes.size() != largest_node_label+1)
+            or (not group_classes.empty()
+                and group_classes.size() != largest_group_label+1))
+    {
+        throw runtime_error("Corrupted sampler state.");
+    }
+    for (auto& edge : edge_list)
+    {
+        if (edge.first > largest_node_label
+                or edge.second > largest_group_label)
+        {
+            throw runtime_error("Corrupted sampler state.");
+        }
+    }
+    sampler.edge_list_ = move(edge_list);
+    sampler.node_stub_vector_ = move(node_stub_vector);
+    sampler.group_stub_vector_ = move(group_stub_vector);
+
+    //bulk rebuild of the edge store
+    sampler.edge_set_.reserve(nb_edges);
+    sampler.edge_set_.insert(sampler.edge_list_.begin(),
+            sampler.edge_list_.end());
+    if (sampler.edge_set_.size() != nb_edges)
+    {
+        throw runtime_error("Corrupted sampler state.");
+    }
+    sampler.frozen_ = move(frozen);
+    sampler.node_classes_ = move(node_classes);
+    sampler.group_classes_ = move(group_classes);
+    sampler.build_buckets();
+
+    //the shared RNG is never touched: other samplers keep their stream, and
+    //copies restored in several processes do not reset each other
+    sampler.local_rng_ = true;
+    sampler.local_gen_ = gen;
+    return sampler;
+}
+
 //verify if two sequences are bigraphic
 bool BipartiteConfigurationModelSampler::is_bigraphic(
         const vector<unsigned int>& seq1,
@@ -37,6 +37,8 @@
 #include <numeric>
 #include <limits>
 #include <cmath>
+#include <cstdint>
+#include <chrono>
 #include "hash_specialization.hpp"
 
 namespace horgg
@@ -48,16 +50,58 @@ typedef std::vector<std::pair<Node,Group> > EdgeList;
 typedef std::unordered_set<std::pair<Node,Group> > EdgeSet;
 typedef std::vector<unsigned int> MembershipSequence;
 typedef std::vector<unsigned int> GroupSizeSequence;
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * Compressed sparse rows: the entries of row i are
+ * indices[indptr[i]], ..., indices[indptr[i+1]-1] (with values data[...]
+ * for weighted matrices). Types match scipy.sparse.
+ */
+struct CompressedRows
+{
+    std::vector<std::int64_t> indptr;
+    std::vector<std::int32_t> indices;
+    std::vector<std::int32_t> data;
+};
 
 //Base class to contain the shared RNG for derived template classes
 class BaseGenerator
 {
     public:
         static void seed(unsigned int seed_value);
+        static unsigned int get_seed() {return seed_value_;}
     protected:
+        static unsigned int seed_value_;
         static RNGType gen_;
 };
 
+/*
+ * Interface for objects following the state of a sampler. Observers are
+ * notified when the whole graph changes and after each accepted edge swap.
+ */
+class SwapObserver
+{
+public:
+    virtual ~SwapObserver() {}
+
+    //the graph was replaced (stub matching, attachment to a sampler, ...)
+    virtual void on_reset(const EdgeList& edge_list) = 0;
+
+    //edges edge1 = (node1,group1) and edge2 = (node2,group2) exchanged their
+    //groups, they are now (node1,group2) and (node2,group1)
+    virtual void on_swap(std::size_t edge1, std::size_t edge2,
+            Node node1, Group group1, Node node2, Group group2) = 0;
+};
+
+//list of observers that is not shared by copies of a sampler
+class ObserverList : public std::vector<SwapObserver*>
+{
+public:
+    ObserverList() {}
+    ObserverList(const ObserverList&): std::vector<SwapObserver*>() {}
+    ObserverList& operator=(const ObserverList&) {return *this;}
+};
+
 /*
  * Class to sample simple bipartite configuration model graphs using MCMC
  */
@@ -68,19 +112,123 @@ public:
             const MembershipSequence& membership_sequence,
             const GroupSizeSequence& group_size_sequence);
 
+    //the sampler draws from its own copy of gen instead of the shared RNG
+    BipartiteConfigurationModelSampler(
+            const MembershipSequence& membership_sequence,
+            const GroupSizeSequence& group_size_sequence,
+            const RNGType& gen);
+
     BipartiteConfigurationModelSampler(const EdgeList& edge_list);
+    //the edges with frozen[i] != 0 are never moved (see set_frozen_edges)
+    BipartiteConfigurationModelSampler(const EdgeList& edge_list,
+            const std::vector<std::uint8_t>& frozen);
 
     //accessor
-    const EdgeList& get_graph() {return edge_list_;}
+    const EdgeList& get_graph() const {return edge_list_;}
+    std::size_t get_nb_nodes() const {return largest_node_label_+1;}
+    std::size_t get_nb_groups() const {return largest_group_label_+1;}
+    MembershipSequence get_membership_sequence() const;
+    GroupSizeSequence get_group_size_sequence() const;
+    //node x group incidence matrix of the current graph in CSR (rows are
+    //nodes) and CSC (rows of the result are groups) format; the buffers are
+    //reused, so the result is overwritten by the next call
+    const CompressedRows& get_incidence_csr();
+    const CompressedRows& get_incidence_csc();
 
     //mutator
     void mcmc_step();
 
+    //mcmc_step in parts, for layers that accept or reject the swaps
+    //themselves. can_swap is false if every proposal would pair an edge with
+    //itself; propose_swap draws two distinct edges that may exchange their
+    //groups and returns false if the swap would create a repeated edge;
+    //apply_swap exchanges their groups and notifies the observers.
+    bool can_swap() const;
+    bool propose_swap(unsigned int& edge1, unsigned int& edge2);
+    void apply_swap(unsigned int edge1, unsigned int edge2);
+
+    //keep edge i of the current graph fixed if frozen[i] != 0: swaps are
+    //only proposed among the mobile edges and the stub matching only
+    //rematches their stubs, without reordering the edges; an empty mask
+    //makes every edge mobile again
+    void set_frozen_edges(const std::vector<std::uint8_t>& frozen);
+    const std::vector<std::uint8_t>& get_frozen_edges() const
+        {return frozen_;}
+    std::size_t get_nb_mobile_edges() const
+        {return buckets_.empty() ? edge_list_.size() : mobile_edges_.size();}
+
+    //only swap edges whose nodes have the same class and whose groups have
+    //the same class (empty labels put everything in one class), so that the
+    //number of edges between each node class and group class of the current
+    //graph is preserved, by the stub matching as well. The mobile edges are
+    //bucketed by pair of classes; the second edge of a swap is drawn in the
+    //bucket of the first one.
+    void set_classes(const std::vector<unsigned int>& node_classes,
+            const std::vector<unsigned int>& group_classes);
+    const std::vector<unsigned int>& get_node_classes() const
+        {return node_classes_;}
+    const std::vector<unsigned int>& get_group_classes() const
+        {return group_classes_;}
+
+    //seed for other RNGs, drawn from the RNG of the sampler
+    unsigned long long draw_seed();
+    //uniform number in [0,1) drawn from the RNG of the sampler
+    double draw_uniform();
+
+    //samplers with their own RNG can be used concurrently
+    void use_local_rng(unsigned long long seed_value,
+            unsigned long long stream=0);
+    bool has_local_rng() const {return local_rng_;}
+
+    //the observer is reset with the current graph, then notified of every
+    //change until detached; it must outlive its attachment. If the reset
+    //throws, the observer is not attached.
+    void attach(SwapObserver* observer);
+    void detach(SwapObserver* observer);
+
     const EdgeList& get_random_graph(unsigned int nb_steps=0);
+    //anytime version: swaps until the budget is spent, with the clock read
+    //after batches of at most DEADLINE_CHECK_INTERVAL swaps, shortened as
+    //the deadline approaches; returns the number of swaps. Throws
+    //std::runtime_error if the stub matching does not finish in time, in
+    //which case the previous graph is kept
+    std::size_t get_random_graph_within(Clock::duration budget);
+    static const std::size_t DEADLINE_CHECK_INTERVAL = 4096;
+    static const std::size_t MIN_DEADLINE_BATCH = 64;
 
-private:
-    bool is_bigraphic(const std::vector<unsigned int>& seq1,
+    //binary checkpoint of the full state, including the RNG the sampler
+    //draws from (the shared one unless it has its own); attached observers
+    //are not part of the state
+    void save_state(std::ostream& output) const;
+    //restore a checkpoint; the restored sampler draws from its own copy of
+    //the saved RNG, so that the chain continues identically without
+    //changing the shared RNG. Checkpoints of older versions, without
+    //frozen edges (version 2) or classes (version 3), are restored with
+    //every edge mobile and a single class. Throws std::runtime_error if the
+    //input is not a valid checkpoint
+    static BipartiteConfigurationModelSampler load_state(std::istream& input);
+    //the same checkpoint in parts, for transports that move the arrays
+    //without copies: a small header (labels and RNG), the stub vectors and
+    //the edge list (get_graph)
+    std::string get_state_header() const;
+    const std::vector<Node>& get_node_stubs() const {return node_stub_vector_;}
+    const std::vector<Group>& get_group_stubs() const
+        {return group_stub_vector_;}
+    static BipartiteConfigurationModelSampler from_state(
+            const std::string& header, EdgeList&& edge_list,
+            std::vector<Node>&& node_stub_vector,
+            std::vector<Group>&& group_stub_vector,
+            std::vector<std::uint8_t>&& frozen=std::vector<std::uint8_t>(),
+            std::vector<unsigned int>&& node_classes=
+                std::vector<unsigned int>(),
+            std::vector<unsigned int>&& group_classes=
+                std::vector<unsigned int>());
+
+    //throws std::invalid_argument if the sequences are not bigraphic
+    static bool is_bigraphic(const std::vector<unsigned int>& seq1,
         const std::vector<unsigned int>& seq2);
+
+private:
     //members
     unsigned int largest_group_label_;
     unsigned int largest_node_label_;
@@ -88,8 +236,30 @@ private:
     std::vector<Node> node_stub_vector_;
     EdgeList edge_list_;
     EdgeSet edge_set_;
+    ObserverList observers_;
+    bool local_rng_;
+    RNGType local_gen_;
+    CompressedRows incidence_csr_;
+    CompressedRows incidence_csc_;
+    //empty if no edge is frozen and there is a single class
+    std::vector<std::uint8_t> frozen_;
+    std::vector<unsigned int> node_classes_;
+    std::vector<unsigned int> group_classes_;
+    std::vector<unsigned int> mobile_edges_;
+    std::vector<std::vector<unsigned int> > buckets_;
+    std::vector<unsigned int> edge_bucket_;
+    std::size_t largest_bucket_size_;
     //utility method
-    void stub_matching();
+    BipartiteConfigurationModelSampler();
+    void initialize(const MembershipSequence& membership_sequence,
+            const GroupSizeSequence& group_size_sequence);
+    void stub_matching(Clock::time_point deadline=Clock::time_point::max());
+    void unbucketed_stub_matching(Clock::time_point deadline,
+            EdgeList& edge_list, EdgeSet& edge_set);
+    void bucketed_stub_matching(Clock::time_point deadline,
+            EdgeList& edge_list, EdgeSet& edge_set);
+    void build_buckets();
+    RNGType& rng() {return local_rng_ ? local_gen_ : gen_;}
 };
 
 inline unsigned int random_int(std::size_t size, RNGType& gen)
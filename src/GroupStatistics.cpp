@@ -0,0 +1,394 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "GroupStatistics.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+namespace
+{//start of anonymous namespace
+
+pair<unsigned int,unsigned int> ordered(unsigned int i, unsigned int j)
+{
+    return (i < j) ? make_pair(i,j) : make_pair(j,i);
+}
+
+//add delta to the count of a pair and update the histogram of the counts
+template <typename PairCount>
+void update_pair(PairCount& counts, PairHistogram& histogram,
+        unsigned int i, unsigned int j, int delta)
+{
+    auto it = counts.emplace(ordered(i,j), 0).first;
+    if (it->second > 0)
+    {
+        histogram[it->second] -= 1;
+    }
+    it->second += delta;
+    if (it->second > 0)
+    {
+        if (it->second >= histogram.size())
+        {
+            histogram.resize(it->second+1, 0);
+        }
+        histogram[it->second] += 1;
+    }
+    else
+    {
+        counts.erase(it);
+    }
+}
+
+//histogram with the number of pairs at 0 filled in
+PairHistogram complete(const PairHistogram& histogram,
+        unsigned long long nb_elements)
+{
+    PairHistogram distribution(histogram);
+    unsigned long long nb_nonzero = 0;
+    for (size_t k = 1; k < distribution.size(); k++)
+    {
+        nb_nonzero += distribution[k];
+    }
+    distribution[0] = nb_elements*(nb_elements-1)/2 - nb_nonzero;
+    return distribution;
+}
+
+}//end of anonymous namespace
+
+/* =================
+ * MembershipLists
+ * ================= */
+
+void MembershipLists::reset(const EdgeList& edge_list, size_t nb_nodes,
+        size_t nb_groups)
+{
+    node_groups_.assign(nb_nodes, vector<Group>());
+    group_nodes_.assign(nb_groups, vector<Node>());
+    for (auto& edge : edge_list)
+    {
+        add(edge.first, edge.second);
+    }
+}
+
+void MembershipLists::add(Node node, Group group)
+{
+    node_groups_[node].push_back(group);
+    group_nodes_[group].push_back(node);
+}
+
+void MembershipLists::remove(Node node, Group group)
+{
+    vector<Group>& groups = node_groups_[node];
+    *find(groups.begin(), groups.end(), group) = groups.back();
+    groups.pop_back();
+    vector<Node>& nodes = group_nodes_[group];
+    *find(nodes.begin(), nodes.end(), node) = nodes.back();
+    nodes.pop_back();
+}
+
+/* =================
+ * GroupOverlapTracker
+ * ================= */
+
+GroupOverlapTracker::GroupOverlapTracker(
+        BipartiteConfigurationModelSampler& sampler):
+    sampler_(sampler),
+    nb_nodes_(sampler.get_nb_nodes()),
+    nb_groups_(sampler.get_nb_groups()),
+    membership_(),
+    overlap_(),
+    co_membership_(),
+    overlap_histogram_(1, 0),
+    co_membership_histogram_(1, 0)
+{
+    sampler_.attach(this);
+}
+
+GroupOverlapTracker::~GroupOverlapTracker()
+{
+    sampler_.detach(this);
+}
+
+void GroupOverlapTracker::on_reset(const EdgeList& edge_list)
+{
+    trace::Span span("overlap_reset");
+    membership_.reset(EdgeList(), nb_nodes_, nb_groups_);
+    overlap_.clear();
+    co_membership_.clear();
+    overlap_histogram_.assign(1, 0);
+    co_membership_histogram_.assign(1, 0);
+    for (auto& edge : edge_list)
+    {
+        add(edge.first, edge.second);
+    }
+}
+
+void GroupOverlapTracker::on_swap(size_t, size_t, Node node1, Group group1,
+        Node node2, Group group2)
+{
+    remove(node1, group1);
+    remove(node2, group2);
+    add(node1, group2);
+    add(node2, group1);
+}
+
+void GroupOverlapTracker::add(Node node, Group group)
+{
+    for (Group other_group : membership_.groups_of(node))
+    {
+        update_pair(overlap_, overlap_histogram_, group, other_group, 1);
+    }
+    for (Node other_node : membership_.nodes_of(group))
+    {
+        update_pair(co_membership_, co_membership_histogram_, node,
+                other_node, 1);
+    }
+    membership_.add(node, group);
+}
+
+void GroupOverlapTracker::remove(Node node, Group group)
+{
+    membership_.remove(node, group);
+    for (Group other_group : membership_.groups_of(node))
+    {
+        update_pair(overlap_, overlap_histogram_, group, other_group, -1);
+    }
+    for (Node other_node : membership_.nodes_of(group))
+    {
+        update_pair(co_membership_, co_membership_histogram_, node,
+                other_node, -1);
+    }
+}
+
+unsigned int GroupOverlapTracker::get_overlap(Group group1,
+        Group group2) const
+{
+    auto it = overlap_.find(ordered(group1, group2));
+    return (it == overlap_.end()) ? 0 : it->second;
+}
+
+unsigned int GroupOverlapTracker::get_co_membership(Node node1,
+        Node node2) const
+{
+    auto it = co_membership_.find(ordered(node1, node2));
+    return (it == co_membership_.end()) ? 0 : it->second;
+}
+
+PairHistogram GroupOverlapTracker::get_overlap_distribution() const
+{
+    return complete(overlap_histogram_, nb_groups_);
+}
+
+PairHistogram GroupOverlapTracker::get_co_membership_distribution() const
+{
+    return complete(co_membership_histogram_, nb_nodes_);
+}
+
+unsigned long long GroupOverlapTracker::get_nb_repeated_pairs() const
+{
+    unsigned long long nb_repeated_pairs = 0;
+    for (size_t k = 2; k < co_membership_histogram_.size(); k++)
+    {
+        nb_repeated_pairs += co_membership_histogram_[k];
+    }
+    return nb_repeated_pairs;
+}
+
+unsigned long long GroupOverlapTracker::get_sum_squared_overlap() const
+{
+    unsigned long long sum_squared_overlap = 0;
+    for (unsigned long long k = 1; k < overlap_histogram_.size(); k++)
+    {
+        sum_squared_overlap += k*k*overlap_histogram_[k];
+    }
+    return sum_squared_overlap;
+}
+
+/* =================
+ * ClusteringTracker
+ * ================= */
+
+ClusteringTracker::ClusteringTracker(
+        BipartiteConfigurationModelSampler& sampler):
+    sampler_(sampler),
+    nb_nodes_(sampler.get_nb_nodes()),
+    nb_groups_(sampler.get_nb_groups()),
+    membership_(),
+    co_membership_(),
+    neighbors_(),
+    node_triangles_(),
+    nb_edges_(0),
+    nb_triangles_(0),
+    nb_triples_(0)
+{
+    sampler_.attach(this);
+}
+
+ClusteringTracker::~ClusteringTracker()
+{
+    sampler_.detach(this);
+}
+
+void ClusteringTracker::on_reset(const EdgeList& edge_list)
+{
+    trace::Span span("clustering_reset");
+    membership_.reset(EdgeList(), nb_nodes_, nb_groups_);
+    co_membership_.clear();
+    neighbors_.assign(nb_nodes_, unordered_set<Node>());
+    node_triangles_.assign(nb_nodes_, 0);
+    nb_edges_ = 0;
+    nb_triangles_ = 0;
+    nb_triples_ = 0;
+    for (auto& edge : edge_list)
+    {
+        add(edge.first, edge.second);
+    }
+}
+
+void ClusteringTracker::on_swap(size_t, size_t, Node node1, Group group1,
+        Node node2, Group group2)
+{
+    remove(node1, group1);
+    remove(node2, group2);
+    add(node1, group2);
+    add(node2, group1);
+}
+
+void ClusteringTracker::add(Node node, Group group)
+{
+    for (Node other_node : membership_.nodes_of(group))
+    {
+        unsigned int& count = co_membership_[ordered(node, other_node)];
+        if (count++ == 0)
+        {
+            add_edge(node, other_node);
+        }
+    }
+    membership_.add(node, group);
+}
+
+void ClusteringTracker::remove(Node node, Group group)
+{
+    membership_.remove(node, group);
+    for (Node other_node : membership_.nodes_of(group))
+    {
+        auto it = co_membership_.find(ordered(node, other_node));
+        if (--(it->second) == 0)
+        {
+            co_membership_.erase(it);
+            remove_edge(node, other_node);
+        }
+    }
+}
+
+void ClusteringTracker::add_edge(Node node1, Node node2)
+{
+    close_triangles(node1, node2, 1);
+    nb_triples_ += neighbors_[node1].size() + neighbors_[node2].size();
+    neighbors_[node1].insert(node2);
+    neighbors_[node2].insert(node1);
+    nb_edges_ += 1;
+}
+
+void ClusteringTracker::remove_edge(Node node1, Node node2)
+{
+    neighbors_[node1].erase(node2);
+    neighbors_[node2].erase(node1);
+    nb_triples_ -= neighbors_[node1].size() + neighbors_[node2].size();
+    close_triangles(node1, node2, -1);
+    nb_edges_ -= 1;
+}
+
+//add (delta = 1) or remove (delta = -1) the triangles formed with the common
+//neighbors of node1 and node2
+void ClusteringTracker::close_triangles(Node node1, Node node2, int delta)
+{
+    const unordered_set<Node>* smallest = &neighbors_[node1];
+    const unordered_set<Node>* largest = &neighbors_[node2];
+    if (smallest->size() > largest->size())
+    {
+        swap(smallest, largest);
+    }
+    unsigned long long nb_common = 0;
+    for (Node node : *smallest)
+    {
+        if (largest->count(node) > 0)
+        {
+            node_triangles_[node] += delta;
+            nb_common += 1;
+        }
+    }
+    if (delta > 0)
+    {
+        node_triangles_[node1] += nb_common;
+        node_triangles_[node2] += nb_common;
+        nb_triangles_ += nb_common;
+    }
+    else
+    {
+        node_triangles_[node1] -= nb_common;
+        node_triangles_[node2] -= nb_common;
+        nb_triangles_ -= nb_common;
+    }
+}
+
+double ClusteringTracker::get_global_clustering() const
+{
+    if (nb_triples_ == 0)
+    {
+        return 0.;
+    }
+    return 3.*nb_triangles_/nb_triples_;
+}
+
+double ClusteringTracker::get_local_clustering(Node node) const
+{
+    double degree = neighbors_[node].size();
+    if (degree < 2)
+    {
+        return 0.;
+    }
+    return 2.*node_triangles_[node]/(degree*(degree-1));
+}
+
+double ClusteringTracker::get_average_clustering() const
+{
+    if (nb_nodes_ == 0)
+    {
+        return 0.;
+    }
+    double total = 0.;
+    for (Node node = 0; node < nb_nodes_; node++)
+    {
+        total += get_local_clustering(node);
+    }
+    return total/nb_nodes_;
+}
+
+}//end of namespace horgg
@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef GROUP_STATISTICS_HPP_
+#define GROUP_STATISTICS_HPP_
+
+#include "GraphGenerator.hpp"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+//groups of each node and nodes of each group, with O(k) updates
+class MembershipLists
+{
+public:
+    void reset(const EdgeList& edge_list, std::size_t nb_nodes,
+            std::size_t nb_groups);
+    void add(Node node, Group group);
+    void remove(Node node, Group group);
+
+    const std::vector<Group>& groups_of(Node node) const
+        {return node_groups_[node];}
+    const std::vector<Node>& nodes_of(Group group) const
+        {return group_nodes_[group];}
+
+private:
+    std::vector<std::vector<Group> > node_groups_;
+    std::vector<std::vector<Node> > group_nodes_;
+};
+
+//number of pairs with each value of a pair count (index 0 is unused)
+typedef std::vector<unsigned long long> PairHistogram;
+
+/*
+ * Pairwise group overlaps (number of shared nodes) and node co-memberships
+ * (number of shared groups), with the distribution of both over the pairs.
+ * The statistics are rebuilt when the graph is reset and updated after each
+ * swap: a node leaving or joining a group only changes the pairs involving
+ * that node or that group, in O(m + n) for membership m and group size n.
+ */
+class GroupOverlapTracker : public SwapObserver
+{
+public:
+    //attach to the sampler, which must outlive this object
+    explicit GroupOverlapTracker(BipartiteConfigurationModelSampler& sampler);
+    ~GroupOverlapTracker();
+
+    GroupOverlapTracker(const GroupOverlapTracker&) = delete;
+    GroupOverlapTracker& operator=(const GroupOverlapTracker&) = delete;
+
+    void on_reset(const EdgeList& edge_list);
+    void on_swap(std::size_t edge1, std::size_t edge2,
+            Node node1, Group group1, Node node2, Group group2);
+
+    unsigned int get_overlap(Group group1, Group group2) const;
+    unsigned int get_co_membership(Node node1, Node node2) const;
+
+    //index k is the number of pairs with overlap (co-membership) k, pairs
+    //with 0 included
+    PairHistogram get_overlap_distribution() const;
+    PairHistogram get_co_membership_distribution() const;
+
+    //number of node pairs sharing more than one group
+    unsigned long long get_nb_repeated_pairs() const;
+    //sum of the squared overlaps over all pairs of groups
+    unsigned long long get_sum_squared_overlap() const;
+
+private:
+    typedef std::unordered_map<std::pair<unsigned int,unsigned int>,
+            unsigned int> PairCount;
+
+    BipartiteConfigurationModelSampler& sampler_;
+    std::size_t nb_nodes_;
+    std::size_t nb_groups_;
+    MembershipLists membership_;
+    PairCount overlap_;
+    PairCount co_membership_;
+    PairHistogram overlap_histogram_;
+    PairHistogram co_membership_histogram_;
+
+    void add(Node node, Group group);
+    void remove(Node node, Group group);
+};
+
+/*
+ * Triangles of the node projection, where two nodes are neighbors if they
+ * share at least one group. Co-membership counts are updated as in
+ * GroupOverlapTracker; when a pair becomes (stops being) an edge of the
+ * projection, the triangles closed by its common neighbors are added
+ * (removed), at a cost bounded by the smallest of the two degrees.
+ */
+class ClusteringTracker : public SwapObserver
+{
+public:
+    //attach to the sampler, which must outlive this object
+    explicit ClusteringTracker(BipartiteConfigurationModelSampler& sampler);
+    ~ClusteringTracker();
+
+    ClusteringTracker(const ClusteringTracker&) = delete;
+    ClusteringTracker& operator=(const ClusteringTracker&) = delete;
+
+    void on_reset(const EdgeList& edge_list);
+    void on_swap(std::size_t edge1, std::size_t edge2,
+            Node node1, Group group1, Node node2, Group group2);
+
+    unsigned long long get_nb_edges() const
+        {return nb_edges_;}
+    unsigned long long get_nb_triangles() const
+        {return nb_triangles_;}
+    std::size_t get_degree(Node node) const
+        {return neighbors_[node].size();}
+    unsigned long long get_nb_triangles(Node node) const
+        {return node_triangles_[node];}
+
+    //3 x triangles / connected triples
+    double get_global_clustering() const;
+    //triangles of the node over pairs of neighbors, 0 if degree < 2
+    double get_local_clustering(Node node) const;
+    //average of the local clustering over all nodes
+    double get_average_clustering() const;
+
+private:
+    typedef std::unordered_map<std::pair<unsigned int,unsigned int>,
+            unsigned int> PairCount;
+
+    BipartiteConfigurationModelSampler& sampler_;
+    std::size_t nb_nodes_;
+    std::size_t nb_groups_;
+    MembershipLists membership_;
+    PairCount co_membership_;
+    std::vector<std::unordered_set<Node> > neighbors_;
+    std::vector<unsigned long long> node_triangles_;
+    unsigned long long nb_edges_;
+    unsigned long long nb_triangles_;
+    unsigned long long nb_triples_;
+
+    void add(Node node, Group group);
+    void remove(Node node, Group group);
+    void add_edge(Node node1, Node node2);
+    void remove_edge(Node node1, Node node2);
+    void close_triangles(Node node1, Node node2, int delta);
+};
+
+}//end of namespace horgg
+
+#endif /* GROUP_STATISTICS_HPP_ */
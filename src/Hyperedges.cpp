@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Hyperedges.hpp"
+#include "Trace.hpp"
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+HyperedgeList::HyperedgeList(BipartiteConfigurationModelSampler& sampler):
+    sampler_(sampler),
+    nb_groups_(sampler.get_nb_groups()),
+    offsets_(),
+    nodes_(),
+    slot_()
+{
+    sampler_.attach(this);
+}
+
+HyperedgeList::~HyperedgeList()
+{
+    sampler_.detach(this);
+}
+
+//counting sort of the edges by group
+void HyperedgeList::on_reset(const EdgeList& edge_list)
+{
+    trace::Span span("hyperedges");
+    offsets_.assign(nb_groups_+1, 0);
+    nodes_.resize(edge_list.size());
+    slot_.resize(edge_list.size());
+    for (auto& edge : edge_list)
+    {
+        offsets_[edge.second+1] += 1;
+    }
+    for (size_t group = 0; group < nb_groups_; group++)
+    {
+        offsets_[group+1] += offsets_[group];
+    }
+    //use offsets_[group] as a cursor, then shift back
+    for (size_t edge = 0; edge < edge_list.size(); edge++)
+    {
+        int64_t& cursor = offsets_[edge_list[edge].second];
+        nodes_[cursor] = edge_list[edge].first;
+        slot_[edge] = cursor;
+        cursor += 1;
+    }
+    for (size_t group = nb_groups_; group > 0; group--)
+    {
+        offsets_[group] = offsets_[group-1];
+    }
+    offsets_[0] = 0;
+}
+
+//node2 takes the place of node1 in the group of edge1 and conversely in
+//the group of edge2
+void HyperedgeList::on_swap(size_t edge1, size_t edge2, Node node1, Group,
+        Node node2, Group)
+{
+    int64_t slot1 = slot_[edge1];
+    int64_t slot2 = slot_[edge2];
+    nodes_[slot1] = node2;
+    nodes_[slot2] = node1;
+    slot_[edge1] = slot2;
+    slot_[edge2] = slot1;
+}
+
+}//end of namespace horgg
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef HYPEREDGES_HPP_
+#define HYPEREDGES_HPP_
+
+#include "GraphGenerator.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Hypergraph view of a sampler: the nodes of group g are
+ * nodes[offsets[g]], ..., nodes[offsets[g+1]-1]. The lists are built in O(E)
+ * when attached (and after each stub matching) and updated in O(1) per swap,
+ * the node replacing the one that left at the same position, so the order
+ * within a group is not sorted. The buffers keep their address as long as
+ * the sampler exists.
+ */
+class HyperedgeList : public SwapObserver
+{
+public:
+    //attach to the sampler, which must outlive this object
+    explicit HyperedgeList(BipartiteConfigurationModelSampler& sampler);
+    ~HyperedgeList();
+
+    HyperedgeList(const HyperedgeList&) = delete;
+    HyperedgeList& operator=(const HyperedgeList&) = delete;
+
+    void on_reset(const EdgeList& edge_list);
+    void on_swap(std::size_t edge1, std::size_t edge2,
+            Node node1, Group group1, Node node2, Group group2);
+
+    const std::vector<std::int64_t>& get_offsets() const {return offsets_;}
+    const std::vector<std::int32_t>& get_nodes() const {return nodes_;}
+
+private:
+    BipartiteConfigurationModelSampler& sampler_;
+    std::size_t nb_groups_;
+    std::vector<std::int64_t> offsets_;
+    std::vector<std::int32_t> nodes_;
+    //position of each edge in nodes_
+    std::vector<std::int64_t> slot_;
+};
+
+}//end of namespace horgg
+
+#endif /* HYPEREDGES_HPP_ */
@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Incidence.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+void build_incidence(const EdgeList& edge_list, size_t nb_nodes,
+        size_t nb_groups, bool by_node, CompressedRows& incidence)
+{
+    trace::Span span("incidence");
+    size_t nb_rows = by_node ? nb_nodes : nb_groups;
+    incidence.indptr.assign(nb_rows+1, 0);
+    incidence.indices.resize(edge_list.size());
+    incidence.data.clear();
+    for (auto& edge : edge_list)
+    {
+        incidence.indptr[(by_node ? edge.first : edge.second)+1] += 1;
+    }
+    for (size_t i = 0; i < nb_rows; i++)
+    {
+        incidence.indptr[i+1] += incidence.indptr[i];
+    }
+    //fill each row from its end (keeping the order of the edge list), after
+    //which indptr[i+1] holds the start of row i
+    for (auto it = edge_list.rbegin(); it != edge_list.rend(); ++it)
+    {
+        Node row = by_node ? it->first : it->second;
+        Node column = by_node ? it->second : it->first;
+        incidence.indices[--incidence.indptr[row+1]] = column;
+    }
+    for (size_t i = 0; i < nb_rows; i++)
+    {
+        incidence.indptr[i] = incidence.indptr[i+1];
+    }
+    incidence.indptr[nb_rows] = edge_list.size();
+}
+
+CompressedRows node_projection(const EdgeList& edge_list, size_t nb_nodes,
+        size_t nb_groups, unsigned int nb_threads)
+{
+    trace::Span span("node_projection");
+    CompressedRows node_groups;
+    CompressedRows group_nodes;
+    build_incidence(edge_list, nb_nodes, nb_groups, true, node_groups);
+    build_incidence(edge_list, nb_nodes, nb_groups, false, group_nodes);
+
+    const size_t chunk_size = 256;
+    const size_t nb_chunks = (nb_nodes + chunk_size - 1)/chunk_size;
+    if (nb_threads == 0)
+    {
+        nb_threads = max(1u, thread::hardware_concurrency());
+    }
+    nb_threads = max<size_t>(1, min<size_t>(nb_threads, nb_chunks));
+    CompressedRows projection;
+    projection.indptr.assign(nb_nodes+1, 0);
+
+    //dense accumulator of each thread, allocated once for both passes: the
+    //weight of v is only valid when marker[v] is the stamp of the current
+    //row and pass, so that nothing is reset between rows
+    struct Scratch
+    {
+        vector<int64_t> marker;
+        vector<int32_t> weight;
+        vector<int32_t> row;
+    };
+    vector<Scratch> scratch(nb_threads);
+
+    //visit the neighbours of every node of the rows handled by each thread
+    auto run = [&](bool fill)
+    {
+        atomic<size_t> next_chunk(0);
+        auto worker = [&](Scratch& accumulator)
+        {
+            vector<int64_t>& marker = accumulator.marker;
+            vector<int32_t>& weight = accumulator.weight;
+            vector<int32_t>& row = accumulator.row;
+            if (marker.empty())
+            {
+                marker.assign(nb_nodes, -1);
+                weight.assign(nb_nodes, 0);
+            }
+            size_t first;
+            while ((first = chunk_size*next_chunk.fetch_add(1)) < nb_nodes)
+            {
+                size_t last = min(nb_nodes, first + chunk_size);
+                for (size_t u = first; u < last; u++)
+                {
+                    //rows are visited again by the second pass
+                    int64_t stamp = fill ? nb_nodes + u : u;
+                    row.clear();
+                    for (int64_t i = node_groups.indptr[u];
+                            i < node_groups.indptr[u+1]; i++)
+                    {
+                        Group group = node_groups.indices[i];
+                        for (int64_t j = group_nodes.indptr[group];
+                                j < group_nodes.indptr[group+1]; j++)
+                        {
+                            int32_t v = group_nodes.indices[j];
+                            if (size_t(v) == u)
+                            {
+                                continue;
+                            }
+                            if (marker[v] != stamp)
+                            {
+                                marker[v] = stamp;
+                                weight[v] = 0;
+                                row.push_back(v);
+                            }
+                            weight[v] += 1;
+                        }
+                    }
+                    if (not fill)
+                    {
+                        projection.indptr[u+1] = row.size();
+                        continue;
+                    }
+                    sort(row.begin(), row.end());
+                    int64_t position = projection.indptr[u];
+                    for (int32_t v : row)
+                    {
+                        projection.indices[position] = v;
+                        projection.data[position] = weight[v];
+                        position += 1;
+                    }
+                }
+            }
+        };
+        vector<thread> threads;
+        for (unsigned int i = 1; i < nb_threads; i++)
+        {
+            threads.emplace_back(worker, ref(scratch[i]));
+        }
+        worker(scratch[0]);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    };
+
+    //first pass for the number of neighbours, second pass to fill the rows
+    run(false);
+    for (size_t u = 0; u < nb_nodes; u++)
+    {
+        projection.indptr[u+1] += projection.indptr[u];
+    }
+    projection.indices.resize(projection.indptr.back());
+    projection.data.resize(projection.indptr.back());
+    run(true);
+    return projection;
+}
+
+}//end of namespace horgg
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef INCIDENCE_HPP_
+#define INCIDENCE_HPP_
+
+#include "GraphGenerator.hpp"
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+//node x group incidence matrix (by_node) or its transpose, by counting sort
+//in O(E). The buffers of `incidence` are reused; data is left empty.
+void build_incidence(const EdgeList& edge_list, std::size_t nb_nodes,
+        std::size_t nb_groups, bool by_node, CompressedRows& incidence);
+
+//weighted node-to-node projection: the weight of (u,v) is the number of
+//groups shared by u and v (no diagonal), with sorted indices in each row.
+//Rows are computed in parallel by at most one thread per chunk of 256 rows,
+//each with a dense accumulator of nb_nodes entries shared by both passes.
+CompressedRows node_projection(const EdgeList& edge_list,
+        std::size_t nb_nodes, std::size_t nb_groups,
+        unsigned int nb_threads=0);
+
+}//end of namespace horgg
+
+#endif /* INCIDENCE_HPP_ */
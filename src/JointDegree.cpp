@@ -0,0 +1,241 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "JointDegree.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+namespace
+{//start of anonymous namespace
+
+//split the stubs of nb_items items among targets receiving counts[t] stubs:
+//stub k of item i is at position k*nb_items + i and each target takes the
+//next counts[t] positions, so that every item gives the floor or the ceiling
+//of counts[t]/nb_items stubs to target t
+vector<vector<unsigned int> > balanced_split(size_t nb_items,
+        const vector<size_t>& counts)
+{
+    vector<vector<unsigned int> > split(counts.size(),
+            vector<unsigned int>(nb_items, 0));
+    size_t position = 0;
+    for (size_t target = 0; target < counts.size(); target++)
+    {
+        for (size_t i = 0; i < counts[target]; i++)
+        {
+            split[target][position % nb_items] += 1;
+            position += 1;
+        }
+    }
+    return split;
+}
+
+//the degrees of the groups of a block differ by at most one: stub k of the
+//block goes to group k mod G, with the groups of largest degree first, so
+//that the consecutive stubs of a node (at most G) reach distinct groups
+void realise_block(const vector<unsigned int>& node_degrees, Node first_node,
+        const vector<unsigned int>& group_degrees, Group first_group,
+        EdgeList& edge_list)
+{
+    unsigned int largest_degree = *max_element(group_degrees.begin(),
+            group_degrees.end());
+    vector<Group> groups;
+    groups.reserve(group_degrees.size());
+    for (Group group = 0; group < group_degrees.size(); group++)
+    {
+        if (group_degrees[group] == largest_degree)
+        {
+            groups.push_back(first_group + group);
+        }
+    }
+    for (Group group = 0; group < group_degrees.size(); group++)
+    {
+        if (group_degrees[group] != largest_degree)
+        {
+            groups.push_back(first_group + group);
+        }
+    }
+
+    size_t stub = 0;
+    for (Node node = 0; node < node_degrees.size(); node++)
+    {
+        for (unsigned int i = 0; i < node_degrees[node]; i++)
+        {
+            edge_list.push_back(make_pair(first_node + node,
+                        groups[stub % groups.size()]));
+            stub += 1;
+        }
+    }
+}
+
+}//end of anonymous namespace
+
+JointDegreeMatrix get_joint_degree_matrix(const EdgeList& edge_list)
+{
+    vector<unsigned int> membership;
+    vector<unsigned int> group_size;
+    for (const auto& edge : edge_list)
+    {
+        if (edge.first >= membership.size())
+        {
+            membership.resize(edge.first+1, 0);
+        }
+        if (edge.second >= group_size.size())
+        {
+            group_size.resize(edge.second+1, 0);
+        }
+        membership[edge.first] += 1;
+        group_size[edge.second] += 1;
+    }
+
+    JointDegreeMatrix matrix;
+    for (const auto& edge : edge_list)
+    {
+        matrix[make_pair(membership[edge.first],
+                group_size[edge.second])] += 1;
+    }
+    return matrix;
+}
+
+EdgeList joint_degree_graph(const JointDegreeMatrix& matrix)
+{
+    //classes of nodes and groups, in increasing order, and their stubs
+    map<unsigned int, size_t> node_stubs;
+    map<unsigned int, size_t> group_stubs;
+    for (const auto& entry : matrix)
+    {
+        if (entry.second == 0)
+        {
+            continue;
+        }
+        if (entry.first.first == 0 or entry.first.second == 0)
+        {
+            throw invalid_argument("Edges must join nodes and groups of "
+                    "positive degree.");
+        }
+        node_stubs[entry.first.first] += entry.second;
+        group_stubs[entry.first.second] += entry.second;
+    }
+
+    vector<unsigned int> memberships;
+    vector<size_t> nb_nodes;
+    vector<Node> first_node;
+    Node nb_labeled_nodes = 0;
+    for (const auto& entry : node_stubs)
+    {
+        if (entry.second % entry.first != 0)
+        {
+            throw invalid_argument("The number of edges of nodes of "
+                    "membership m must be a multiple of m.");
+        }
+        memberships.push_back(entry.first);
+        nb_nodes.push_back(entry.second/entry.first);
+        first_node.push_back(nb_labeled_nodes);
+        nb_labeled_nodes += nb_nodes.back();
+    }
+    vector<unsigned int> group_sizes;
+    vector<size_t> nb_groups;
+    vector<Group> first_group;
+    Group nb_labeled_groups = 0;
+    for (const auto& entry : group_stubs)
+    {
+        if (entry.second % entry.first != 0)
+        {
+            throw invalid_argument("The number of edges of groups of "
+                    "size s must be a multiple of s.");
+        }
+        group_sizes.push_back(entry.first);
+        nb_groups.push_back(entry.second/entry.first);
+        first_group.push_back(nb_labeled_groups);
+        nb_labeled_groups += nb_groups.back();
+    }
+
+    //dense matrix of the blocks
+    vector<vector<size_t> > counts(memberships.size(),
+            vector<size_t>(group_sizes.size(), 0));
+    vector<vector<size_t> > transposed_counts(group_sizes.size(),
+            vector<size_t>(memberships.size(), 0));
+    for (size_t i = 0; i < memberships.size(); i++)
+    {
+        for (size_t j = 0; j < group_sizes.size(); j++)
+        {
+            auto it = matrix.find(make_pair(memberships[i], group_sizes[j]));
+            if (it == matrix.end())
+            {
+                continue;
+            }
+            if (it->second > nb_nodes[i]*nb_groups[j])
+            {
+                throw invalid_argument("A block has more edges than pairs "
+                        "of nodes and groups.");
+            }
+            counts[i][j] = it->second;
+            transposed_counts[j][i] = it->second;
+        }
+    }
+
+    vector<vector<vector<unsigned int> > > node_degrees;
+    for (size_t i = 0; i < memberships.size(); i++)
+    {
+        node_degrees.push_back(balanced_split(nb_nodes[i], counts[i]));
+    }
+    vector<vector<vector<unsigned int> > > group_degrees;
+    for (size_t j = 0; j < group_sizes.size(); j++)
+    {
+        group_degrees.push_back(balanced_split(nb_groups[j],
+                    transposed_counts[j]));
+    }
+
+    EdgeList edge_list;
+    for (size_t i = 0; i < memberships.size(); i++)
+    {
+        for (size_t j = 0; j < group_sizes.size(); j++)
+        {
+            if (counts[i][j] > 0)
+            {
+                realise_block(node_degrees[i][j], first_node[i],
+                        group_degrees[j][i], first_group[j], edge_list);
+            }
+        }
+    }
+    return edge_list;
+}
+
+void preserve_joint_degrees(BipartiteConfigurationModelSampler& sampler,
+        bool by_membership, bool by_group_size)
+{
+    sampler.set_classes(
+            by_membership ? sampler.get_membership_sequence()
+                : vector<unsigned int>(),
+            by_group_size ? sampler.get_group_size_sequence()
+                : vector<unsigned int>());
+}
+
+}//end of namespace horgg
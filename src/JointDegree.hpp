@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef JOINT_DEGREE_HPP_
+#define JOINT_DEGREE_HPP_
+
+#include "GraphGenerator.hpp"
+#include <map>
+#include <utility>
+
+namespace horgg
+{//start of namespace horgg
+
+//number of edges between nodes of membership m and groups of size s, indexed
+//by (m, s)
+typedef std::map<std::pair<unsigned int,unsigned int>, std::size_t>
+    JointDegreeMatrix;
+
+//joint degree matrix of a graph; nodes and groups without edges are ignored
+JointDegreeMatrix get_joint_degree_matrix(const EdgeList& edge_list);
+
+/*
+ * Simple graph with the given joint degree matrix. Nodes are labeled by
+ * increasing membership and groups by increasing size. The stubs of each
+ * class of nodes (groups) are split among the classes of groups (nodes) so
+ * that the degrees inside each block (m, s) differ by at most one; the
+ * stubs of the nodes of a block are then dealt to its groups in round-robin
+ * order, which is simple for such balanced degrees, in O(edges). Throws
+ * std::invalid_argument if the matrix is not graphic.
+ */
+EdgeList joint_degree_graph(const JointDegreeMatrix& matrix);
+
+//restrict the swaps of the sampler so that they preserve the joint degree
+//matrix: with by_membership, groups are only exchanged between edges whose
+//nodes have the same membership; with by_group_size, between groups of the
+//same size (both may be combined; neither makes every swap possible again)
+void preserve_joint_degrees(BipartiteConfigurationModelSampler& sampler,
+        bool by_membership=true, bool by_group_size=false);
+
+}//end of namespace horgg
+
+#endif /* JOINT_DEGREE_HPP_ */
@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "MetropolisHastings.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+void AssortativityEnergy::reset(const EdgeList& edge_list)
+{
+    membership_.clear();
+    group_size_.clear();
+    for (const auto& edge : edge_list)
+    {
+        if (edge.first >= membership_.size())
+        {
+            membership_.resize(edge.first+1, 0);
+        }
+        if (edge.second >= group_size_.size())
+        {
+            group_size_.resize(edge.second+1, 0);
+        }
+        membership_[edge.first] += 1;
+        group_size_[edge.second] += 1;
+    }
+
+    energy_ = 0;
+    nb_edges_ = edge_list.size();
+    double sum_membership = 0.;
+    double sum_group_size = 0.;
+    double sum_squared_membership = 0.;
+    double sum_squared_group_size = 0.;
+    unsigned int min_membership = numeric_limits<unsigned int>::max();
+    unsigned int max_membership = 0;
+    unsigned int min_group_size = numeric_limits<unsigned int>::max();
+    unsigned int max_group_size = 0;
+    for (const auto& edge : edge_list)
+    {
+        unsigned int membership = membership_[edge.first];
+        unsigned int group_size = group_size_[edge.second];
+        energy_ -= static_cast<long long>(membership)*group_size;
+        sum_membership += membership;
+        sum_group_size += group_size;
+        sum_squared_membership += static_cast<double>(membership)*membership;
+        sum_squared_group_size += static_cast<double>(group_size)*group_size;
+        min_membership = min(min_membership, membership);
+        max_membership = max(max_membership, membership);
+        min_group_size = min(min_group_size, group_size);
+        max_group_size = max(max_group_size, group_size);
+    }
+
+    max_delta_ = 0;
+    mean_membership_ = 0.;
+    mean_group_size_ = 0.;
+    std_membership_ = 0.;
+    std_group_size_ = 0.;
+    if (nb_edges_ > 0)
+    {
+        max_delta_ = static_cast<long long>(max_membership - min_membership)
+            *(max_group_size - min_group_size);
+        mean_membership_ = sum_membership/nb_edges_;
+        mean_group_size_ = sum_group_size/nb_edges_;
+        std_membership_ = sqrt(max(0., sum_squared_membership/nb_edges_
+                    - mean_membership_*mean_membership_));
+        std_group_size_ = sqrt(max(0., sum_squared_group_size/nb_edges_
+                    - mean_group_size_*mean_group_size_));
+    }
+}
+
+double AssortativityEnergy::get_assortativity() const
+{
+    if (std_membership_ == 0. or std_group_size_ == 0.)
+    {
+        return 0.;
+    }
+    double covariance = -energy_/nb_edges_
+        - mean_membership_*mean_group_size_;
+    return covariance/(std_membership_*std_group_size_);
+}
+
+}//end of namespace horgg
@@ -0,0 +1,196 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef METROPOLIS_HASTINGS_HPP_
+#define METROPOLIS_HASTINGS_HPP_
+
+#include "GraphGenerator.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Energy policy of the Metropolis-Hastings layer: minus the sum over edges of
+ * the membership of the node times the size of the group, so that positive
+ * inverse temperatures favour assortative graphs and negative ones
+ * disassortative graphs. Memberships and group sizes do not change with
+ * swaps, hence the change of energy is computed in O(1).
+ *
+ * An energy policy provides reset (rebuild from a graph), delta (integer
+ * change of energy of a swap), update (apply an accepted swap), max_delta
+ * (bound on |delta| for the acceptance table, 0 if unknown) and
+ * get_energy.
+ */
+class AssortativityEnergy
+{
+public:
+    void reset(const EdgeList& edge_list);
+
+    //(node1,group1), (node2,group2) -> (node1,group2), (node2,group1)
+    long long delta(Node node1, Group group1, Node node2, Group group2) const
+    {
+        return -(static_cast<long long>(membership_[node1])
+                - membership_[node2])
+            *(static_cast<long long>(group_size_[group2])
+                - group_size_[group1]);
+    }
+
+    void update(Node node1, Group group1, Node node2, Group group2)
+        {energy_ += delta(node1, group1, node2, group2);}
+
+    long long max_delta() const {return max_delta_;}
+    double get_energy() const {return energy_;}
+
+    //Pearson correlation of the membership and the group size over edges
+    double get_assortativity() const;
+
+private:
+    std::vector<unsigned int> membership_;
+    std::vector<unsigned int> group_size_;
+    long long energy_;
+    long long max_delta_;
+    //moments over edges, invariant under swaps
+    double nb_edges_;
+    double mean_membership_;
+    double mean_group_size_;
+    double std_membership_;
+    double std_group_size_;
+};
+
+/*
+ * Metropolis-Hastings layer over the swaps of a sampler: a swap proposed by
+ * the sampler is applied with probability min(1, exp(-beta*delta)), where
+ * delta is the change of the energy policy, so that the graphs are sampled
+ * with weight exp(-beta*E). The energy follows the sampler as an observer
+ * (it is also rebuilt by get_random_graph). Energies are integers, so the
+ * acceptance probabilities are tabulated for every |delta| up to the bound
+ * of the policy instead of calling exp at each step.
+ */
+template<class Energy>
+class MetropolisHastingsSampler : public SwapObserver
+{
+public:
+    //attach to the sampler, which must outlive this object; the sampler
+    //drops the observer again if the energy cannot be built
+    MetropolisHastingsSampler(BipartiteConfigurationModelSampler& sampler,
+            double beta, const Energy& energy=Energy()):
+        sampler_(sampler), energy_(energy), beta_(beta), acceptance_table_()
+    {
+        sampler_.attach(this);
+    }
+    ~MetropolisHastingsSampler() {sampler_.detach(this);}
+
+    MetropolisHastingsSampler(const MetropolisHastingsSampler&) = delete;
+    MetropolisHastingsSampler& operator=(
+            const MetropolisHastingsSampler&) = delete;
+
+    void on_reset(const EdgeList& edge_list) override
+    {
+        energy_.reset(edge_list);
+        build_table();
+    }
+
+    void on_swap(std::size_t, std::size_t, Node node1, Group group1,
+            Node node2, Group group2) override
+        {energy_.update(node1, group1, node2, group2);}
+
+    //propose one swap; returns true if it was applied
+    bool mcmc_step()
+    {
+        unsigned int edge1;
+        unsigned int edge2;
+        if (not sampler_.can_swap() or not sampler_.propose_swap(edge1, edge2))
+        {
+            return false;
+        }
+        const EdgeList& edge_list = sampler_.get_graph();
+        long long delta = energy_.delta(
+                edge_list[edge1].first, edge_list[edge1].second,
+                edge_list[edge2].first, edge_list[edge2].second);
+        if (beta_*delta > 0. and
+                sampler_.draw_uniform() >= acceptance(std::llabs(delta)))
+        {
+            return false;
+        }
+        sampler_.apply_swap(edge1, edge2);
+        return true;
+    }
+
+    //returns the number of accepted swaps
+    std::size_t mcmc_step(std::size_t nb_steps)
+    {
+        std::size_t nb_accepted = 0;
+        for (std::size_t step = 0; step < nb_steps; step++)
+        {
+            nb_accepted += mcmc_step();
+        }
+        return nb_accepted;
+    }
+
+    double get_beta() const {return beta_;}
+    void set_beta(double beta) {beta_ = beta; build_table();}
+    const Energy& get_energy() const {return energy_;}
+
+private:
+    //tables are only built for bounds up to this size
+    static const long long MAX_TABLE_SIZE = 1 << 16;
+
+    BipartiteConfigurationModelSampler& sampler_;
+    Energy energy_;
+    double beta_;
+    //exp(-|beta| k) for k = 0, ..., max_delta
+    std::vector<double> acceptance_table_;
+
+    void build_table()
+    {
+        acceptance_table_.clear();
+        long long max_delta = energy_.max_delta();
+        if (max_delta > 0 and max_delta < MAX_TABLE_SIZE)
+        {
+            acceptance_table_.resize(max_delta+1);
+            for (long long k = 0; k <= max_delta; k++)
+            {
+                acceptance_table_[k] = std::exp(-std::fabs(beta_)*k);
+            }
+        }
+    }
+
+    double acceptance(long long abs_delta) const
+    {
+        if (abs_delta < static_cast<long long>(acceptance_table_.size()))
+        {
+            return acceptance_table_[abs_delta];
+        }
+        return std::exp(-std::fabs(beta_)*abs_delta);
+    }
+};
+
+}//end of namespace horgg
+
+#endif /* METROPOLIS_HASTINGS_HPP_ */
@@ -0,0 +1,244 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Pipeline.hpp"
+#include "SequenceGenerator.hpp"
+#include "Trace.hpp"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+namespace
+{//start of anonymous namespace
+
+//appends and removals of sequence_2 per stub before giving up on a draw
+const size_t SEQUENCE_2_ITERATIONS_PER_STUB = 16;
+const size_t SEQUENCE_2_MIN_ITERATIONS = 1 << 16;
+
+}//end of anonymous namespace
+
+EdgeList sample_graph(const PipelineParameters& parameters,
+        unsigned long long stream)
+{
+    trace::Span span("sample_graph");
+    RNGType gen(parameters.seed, stream);
+    //invalid distributions are not worth redrawing
+    AliasSampler group_size_validation(parameters.group_size_dist);
+    AliasSampler membership_validation(parameters.membership_dist);
+
+    string last_error;
+    for (unsigned int attempt = 0; attempt < parameters.max_attempts;
+            attempt++)
+    {
+        try
+        {
+            GroupSizeSequence group_size_sequence = sequence_1(
+                    parameters.nb_groups, parameters.group_size_dist, gen);
+            unsigned long long nb_stubs = 0;
+            for (unsigned int size : group_size_sequence)
+            {
+                nb_stubs += size;
+            }
+            MembershipSequence membership_sequence = parameters.exact_sum ?
+                sequence_2_exact(group_size_sequence,
+                        parameters.membership_dist, gen) :
+                sequence_2(group_size_sequence, parameters.membership_dist,
+                        gen, SEQUENCE_2_ITERATIONS_PER_STUB*nb_stubs
+                        + SEQUENCE_2_MIN_ITERATIONS);
+            //the constructor already performs the stub matching
+            BipartiteConfigurationModelSampler sampler(membership_sequence,
+                    group_size_sequence, gen);
+            trace::Span mcmc_span("mcmc");
+            for (unsigned int i = 0; i < parameters.nb_steps; i++)
+            {
+                sampler.mcmc_step();
+            }
+            return sampler.get_graph();
+        }
+        catch (invalid_argument& e)
+        {
+            //unreachable exact sum or sequences that are not bigraphic
+            last_error = e.what();
+        }
+        catch (runtime_error& e)
+        {
+            //sum not reached by sequence_2
+            last_error = e.what();
+        }
+    }
+    throw runtime_error("No graph sampled in the given number of attempts: "
+            + last_error);
+}
+
+vector<EdgeList> sample_graphs(const PipelineParameters& parameters,
+        size_t nb_graphs, unsigned int nb_threads)
+{
+    if (nb_threads == 0)
+    {
+        nb_threads = max(1u, thread::hardware_concurrency());
+    }
+    nb_threads = min<size_t>(nb_threads, max<size_t>(nb_graphs, 1));
+
+    vector<EdgeList> graphs(nb_graphs);
+    atomic<size_t> next_graph(0);
+    exception_ptr error;
+    mutex error_mutex;
+    auto worker = [&]()
+    {
+        size_t index;
+        while ((index = next_graph.fetch_add(1)) < nb_graphs)
+        {
+            try
+            {
+                graphs[index] = sample_graph(parameters, index);
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(error_mutex);
+                if (not error)
+                {
+                    error = current_exception();
+                }
+                next_graph = nb_graphs;
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned int i = 1; i < nb_threads; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    if (error)
+    {
+        rethrow_exception(error);
+    }
+    return graphs;
+}
+
+bool sample_graph(BipartiteConfigurationModelSampler& sampler,
+        unsigned int nb_steps, unsigned long long seed,
+        unsigned long long stream, const atomic<bool>& cancelled,
+        EdgeList& edge_list)
+{
+    trace::Span span("sample_graph");
+    if (cancelled)
+    {
+        return false;
+    }
+    sampler.use_local_rng(seed, stream);
+    sampler.get_random_graph();
+    trace::Span mcmc_span("mcmc");
+    const size_t interval =
+        BipartiteConfigurationModelSampler::DEADLINE_CHECK_INTERVAL;
+    for (unsigned int i = 0; i < nb_steps; i++)
+    {
+        if (i % interval == 0 and cancelled)
+        {
+            return false;
+        }
+        sampler.mcmc_step();
+    }
+    edge_list = sampler.get_graph();
+    return true;
+}
+
+/* =================
+ * TaskPool
+ * ================= */
+
+TaskPool::TaskPool(unsigned int nb_threads):
+    tasks_(),
+    stopped_(false),
+    mutex_(),
+    task_ready_(),
+    threads_()
+{
+    if (nb_threads == 0)
+    {
+        nb_threads = max(1u, thread::hardware_concurrency());
+    }
+    for (unsigned int i = 0; i < nb_threads; i++)
+    {
+        threads_.emplace_back(&TaskPool::work, this);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    task_ready_.notify_all();
+    for (auto& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void TaskPool::submit(function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        tasks_.push_back(move(task));
+    }
+    task_ready_.notify_one();
+}
+
+void TaskPool::work()
+{
+    while (true)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(mutex_);
+            task_ready_.wait(lock, [&]()
+                {
+                    return stopped_ or not tasks_.empty();
+                });
+            if (tasks_.empty())
+            {
+                return;
+            }
+            task = move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+}//end of namespace horgg
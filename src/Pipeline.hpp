@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef PIPELINE_HPP_
+#define PIPELINE_HPP_
+
+#include "GraphGenerator.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * End-to-end generation: the group sizes of nb_groups groups are drawn from
+ * group_size_dist (sequence_1), the memberships from membership_dist with
+ * the same number of stubs (sequence_2, or sequence_2_exact when
+ * exact_sum), then a graph is sampled with nb_steps edge swaps after the
+ * stub matching. Graph i of a batch uses stream i of the RNG seeded with
+ * seed, so the output does not depend on the number of threads. Sequences
+ * whose sums cannot be matched or that are not bigraphic are redrawn, at
+ * most max_attempts times before std::runtime_error is thrown.
+ */
+struct PipelineParameters
+{
+    std::vector<double> group_size_dist;
+    std::vector<double> membership_dist;
+    std::size_t nb_groups;
+    unsigned long long seed;
+    unsigned int nb_steps;
+    bool exact_sum;
+    unsigned int max_attempts;
+};
+
+EdgeList sample_graph(const PipelineParameters& parameters,
+        unsigned long long stream=0);
+
+//nb_threads = 0 uses the hardware concurrency
+std::vector<EdgeList> sample_graphs(const PipelineParameters& parameters,
+        std::size_t nb_graphs, unsigned int nb_threads=0);
+
+//graph drawn like sampler.get_random_graph(nb_steps), so that its frozen
+//edges and classes are kept, with sampler switched to stream of the RNG
+//seeded with seed; gives up and returns false once cancelled is set,
+//checked every DEADLINE_CHECK_INTERVAL swaps
+bool sample_graph(BipartiteConfigurationModelSampler& sampler,
+        unsigned int nb_steps, unsigned long long seed,
+        unsigned long long stream, const std::atomic<bool>& cancelled,
+        EdgeList& edge_list);
+
+/*
+ * Fixed set of threads running tasks in submission order.
+ */
+class TaskPool
+{
+public:
+    //nb_threads = 0 uses the hardware concurrency
+    explicit TaskPool(unsigned int nb_threads=0);
+    //waits for the tasks already submitted
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    std::size_t get_nb_threads() const {return threads_.size();}
+
+private:
+    std::deque<std::function<void()> > tasks_;
+    bool stopped_;
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    std::vector<std::thread> threads_;
+
+    void work();
+};
+
+}//end of namespace horgg
+
+#endif /* PIPELINE_HPP_ */
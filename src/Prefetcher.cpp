@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Prefetcher.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+GraphPrefetcher::GraphPrefetcher(
+        const BipartiteConfigurationModelSampler& sampler, size_t nb_graphs,
+        unsigned int nb_steps, size_t prefetch, unsigned int nb_threads,
+        unsigned long long seed):
+    nb_graphs_(nb_graphs),
+    prefetch_(max<size_t>(prefetch, 1)),
+    next_graph_(0),
+    stopped_(false),
+    cancelled_(false),
+    ready_(),
+    error_(),
+    mutex_(),
+    graph_ready_(),
+    slot_free_(),
+    workers_()
+{
+    nb_threads = max(1u, nb_threads);
+    nb_threads = min<size_t>(nb_threads, max<size_t>(nb_graphs, 1));
+    try
+    {
+        for (unsigned int w = 0; w < nb_threads; w++)
+        {
+            BipartiteConfigurationModelSampler worker_sampler(sampler);
+            worker_sampler.use_local_rng(seed, w);
+            workers_.emplace_back(&GraphPrefetcher::work, this,
+                    move(worker_sampler), w, nb_threads, nb_steps);
+        }
+    }
+    catch (...)
+    {
+        stop();
+        throw;
+    }
+}
+
+GraphPrefetcher::~GraphPrefetcher()
+{
+    stop();
+}
+
+void GraphPrefetcher::stop()
+{
+    cancelled_ = true;
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    slot_free_.notify_all();
+    graph_ready_.notify_all();
+    for (thread& worker : workers_)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void GraphPrefetcher::work(BipartiteConfigurationModelSampler sampler,
+        size_t first, size_t stride, unsigned int nb_steps)
+{
+    for (size_t index = first; index < nb_graphs_; index += stride)
+    {
+        {
+            unique_lock<mutex> lock(mutex_);
+            slot_free_.wait(lock, [&]()
+                {
+                    return stopped_ or index < next_graph_ + prefetch_;
+                });
+            if (stopped_)
+            {
+                return;
+            }
+        }
+        try
+        {
+            trace::Span span("prefetch");
+            //get_random_graph(nb_steps), with the swaps interrupted by stop
+            sampler.get_random_graph();
+            const size_t interval =
+                BipartiteConfigurationModelSampler::DEADLINE_CHECK_INTERVAL;
+            for (unsigned int i = 0; i < nb_steps; i++)
+            {
+                if (i % interval == 0 and cancelled_)
+                {
+                    return;
+                }
+                sampler.mcmc_step();
+            }
+            EdgeList edge_list = sampler.get_graph();
+            lock_guard<mutex> lock(mutex_);
+            ready_.emplace(index, move(edge_list));
+        }
+        catch (...)
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (not error_)
+            {
+                error_ = current_exception();
+            }
+            stopped_ = true;
+        }
+        graph_ready_.notify_all();
+        slot_free_.notify_all();
+    }
+}
+
+bool GraphPrefetcher::next(EdgeList& edge_list)
+{
+    unique_lock<mutex> lock(mutex_);
+    if (next_graph_ == nb_graphs_)
+    {
+        return false;
+    }
+    graph_ready_.wait(lock, [&]()
+        {
+            return stopped_ or ready_.count(next_graph_) > 0;
+        });
+    if (error_)
+    {
+        rethrow_exception(error_);
+    }
+    auto it = ready_.find(next_graph_);
+    if (it == ready_.end())
+    {
+        //stopped before this graph was produced
+        return false;
+    }
+    edge_list = move(it->second);
+    ready_.erase(it);
+    next_graph_ += 1;
+    lock.unlock();
+    slot_free_.notify_all();
+    return true;
+}
+
+}//end of namespace horgg
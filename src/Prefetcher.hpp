@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef PREFETCHER_HPP_
+#define PREFETCHER_HPP_
+
+#include "GraphGenerator.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Random graphs generated ahead of their consumption by worker threads.
+ * Each worker owns a copy of the sampler with its own RNG (stream w of
+ * seed for worker w) and draws graphs w, w + nb_threads, ...; a worker
+ * waits while its next graph is prefetch or more graphs ahead of the
+ * consumer. Graphs are returned in order, so the sequence only depends on
+ * the seed and the number of threads.
+ */
+class GraphPrefetcher
+{
+public:
+    GraphPrefetcher(const BipartiteConfigurationModelSampler& sampler,
+            std::size_t nb_graphs, unsigned int nb_steps,
+            std::size_t prefetch, unsigned int nb_threads,
+            unsigned long long seed);
+    ~GraphPrefetcher();
+
+    GraphPrefetcher(const GraphPrefetcher&) = delete;
+    GraphPrefetcher& operator=(const GraphPrefetcher&) = delete;
+
+    //wait for the next graph; returns false once all graphs were consumed,
+    //rethrows the exception of a worker
+    bool next(EdgeList& edge_list);
+
+    //stop the workers without waiting for the remaining graphs; a graph
+    //being generated is abandoned within DEADLINE_CHECK_INTERVAL swaps
+    void stop();
+
+    std::size_t size() const {return nb_graphs_;}
+
+private:
+    std::size_t nb_graphs_;
+    std::size_t prefetch_;
+    std::size_t next_graph_;
+    bool stopped_;
+    //read by the workers between swaps, without the mutex
+    std::atomic<bool> cancelled_;
+    std::map<std::size_t, EdgeList> ready_;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable graph_ready_;
+    std::condition_variable slot_free_;
+    std::vector<std::thread> workers_;
+
+    void work(BipartiteConfigurationModelSampler sampler, std::size_t first,
+            std::size_t stride, unsigned int nb_steps);
+};
+
+}//end of namespace horgg
+
+#endif /* PREFETCHER_HPP_ */
@@ -0,0 +1,370 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "SequenceGenerator.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+/* =================
+ * AliasSampler
+ * ================= */
+
+//Vose's method, O(size) construction
+AliasSampler::AliasSampler(const vector<double>& weights):
+    probability_(weights.size(), 0.),
+    alias_(weights.size(), 0)
+{
+    double total = 0;
+    for (double weight : weights)
+    {
+        if (not (weight >= 0) or isinf(weight))
+        {
+            throw invalid_argument(
+                    "Distribution weights must be finite and non-negative.");
+        }
+        total += weight;
+    }
+    if (not (total > 0))
+    {
+        throw invalid_argument("Distribution must have a positive sum.");
+    }
+
+    vector<unsigned int> small;
+    vector<unsigned int> large;
+    vector<double> scaled(weights.size());
+    for (unsigned int i = 0; i < weights.size(); i++)
+    {
+        scaled[i] = weights[i]*weights.size()/total;
+        if (scaled[i] < 1)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+    while (not small.empty() and not large.empty())
+    {
+        unsigned int less = small.back();
+        small.pop_back();
+        unsigned int more = large.back();
+        probability_[less] = scaled[less];
+        alias_[less] = more;
+        scaled[more] -= 1 - scaled[less];
+        if (scaled[more] < 1)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    //the remaining entries are 1 up to rounding errors
+    for (unsigned int i : large)
+    {
+        probability_[i] = 1;
+        alias_[i] = i;
+    }
+    for (unsigned int i : small)
+    {
+        probability_[i] = 1;
+        alias_[i] = i;
+    }
+}
+
+/* =================
+ * Sequences
+ * ================= */
+
+void sequence_1(unsigned int* sequence, size_t size,
+        const vector<double>& dist, RNGType& gen)
+{
+    trace::Span span("sequence_1");
+    AliasSampler sampler(dist);
+    for (size_t i = 0; i < size; i++)
+    {
+        sequence[i] = sampler(gen);
+    }
+}
+
+vector<unsigned int> sequence_1(size_t size, const vector<double>& dist,
+        RNGType& gen)
+{
+    vector<unsigned int> sequence(size);
+    sequence_1(sequence.data(), size, dist, gen);
+    return sequence;
+}
+
+vector<unsigned int> sequence_2(const vector<unsigned int>& seq_1,
+        const vector<double>& dist, RNGType& gen, size_t max_iterations)
+{
+    trace::Span span("sequence_2");
+    AliasSampler sampler(dist);
+    unsigned long long seq_1_stub = 0;
+    for (unsigned int value : seq_1)
+    {
+        seq_1_stub += value;
+    }
+    if (seq_1_stub > 0 and
+            find_if(dist.begin()+1, dist.end(), [](double weight)
+                {return weight > 0;}) == dist.end())
+    {
+        throw invalid_argument("Distribution only has the value 0.");
+    }
+
+    vector<unsigned int> seq_2;
+    unsigned long long seq_2_stub = 0;
+    //generate new sequence number until the sum is coherent with seq_1
+    size_t nb_iterations = 0;
+    while (seq_2_stub != seq_1_stub)
+    {
+        nb_iterations += 1;
+        if (nb_iterations == max_iterations + 1 and max_iterations > 0)
+        {
+            throw runtime_error("The sum of seq_1 was not reached in the "
+                    "given number of iterations.");
+        }
+        if (seq_2_stub < seq_1_stub)
+        {
+            seq_2.push_back(sampler(gen));
+            seq_2_stub += seq_2.back();
+        }
+        else
+        {
+            unsigned int index = random_int(seq_2.size(), gen);
+            swap(seq_2[index], seq_2.back());
+            seq_2_stub -= seq_2.back();
+            seq_2.pop_back();
+        }
+    }
+    return seq_2;
+}
+
+namespace
+{//start of anonymous namespace
+
+//the table of hitting probabilities covers at least this many operations
+const size_t HIT_TABLE_BUDGET = 1 << 20;
+//and at most this many (see sequence_2_exact)
+const unsigned long long MAX_HIT_TABLE_OPERATIONS = 1ULL << 27;
+
+unsigned int greatest_common_divisor(unsigned int a, unsigned int b)
+{
+    while (b != 0)
+    {
+        unsigned int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+}//end of anonymous namespace
+
+vector<unsigned int> sequence_2_exact(const vector<unsigned int>& seq_1,
+        const vector<double>& dist, RNGType& gen, bool ensure_bigraphic,
+        unsigned int max_attempts)
+{
+    trace::Span span("sequence_2_exact");
+    AliasSampler validation(dist); //throws for invalid distributions
+    unsigned long long total = 0;
+    for (unsigned int value : seq_1)
+    {
+        total += value;
+    }
+
+    //distribution of the non-zero values, divided by their gcd
+    vector<unsigned int> support;
+    vector<double> weight;
+    double nonzero_weight = 0;
+    double zero_weight = dist.empty() ? 0 : dist[0];
+    unsigned int period = 0;
+    for (unsigned int k = 1; k < dist.size(); k++)
+    {
+        if (dist[k] > 0)
+        {
+            support.push_back(k);
+            weight.push_back(dist[k]);
+            nonzero_weight += dist[k];
+            period = greatest_common_divisor(period, k);
+        }
+    }
+    if (support.empty())
+    {
+        //every value is 0: only the empty sequence has the sum 0
+        if (total > 0)
+        {
+            throw invalid_argument("Distribution only has the value 0.");
+        }
+        return vector<unsigned int>();
+    }
+    if (total % period != 0)
+    {
+        throw invalid_argument(
+                "No sequence drawn from the distribution has the same sum.");
+    }
+    for (size_t i = 0; i < support.size(); i++)
+    {
+        support[i] /= period;
+        weight[i] /= nonzero_weight;
+    }
+    unsigned long long scaled_total = total/period;
+
+    //hit[r] = probability that the partial sums of non-zero values hit r, for
+    //r up to a window beyond the Frobenius number of the support (bounded by
+    //(min-1)(max-1)), so that every remaining sum above it can be reached
+    unsigned long long largest = support.back();
+    unsigned long long smallest = support.front();
+    unsigned long long operation_limit =
+        MAX_HIT_TABLE_OPERATIONS/support.size();
+    unsigned long long window = numeric_limits<unsigned long long>::max();
+    if (smallest == 1 or largest - 1 <= operation_limit/(smallest - 1))
+    {
+        window = max(2*largest, (smallest-1)*(largest-1) + largest);
+    }
+    if (min(window, scaled_total) > operation_limit)
+    {
+        throw invalid_argument("Distribution support is too wide and sparse "
+                "for the exact sampler; use sequence_2.");
+    }
+    window = max(window, static_cast<unsigned long long>(
+                HIT_TABLE_BUDGET/support.size()));
+    window = min(window, scaled_total);
+    vector<double> hit(window+1, 0.);
+    hit[0] = 1;
+    for (unsigned long long s = 1; s <= window; s++)
+    {
+        double probability = 0;
+        for (size_t i = 0; i < support.size() and support[i] <= s; i++)
+        {
+            probability += weight[i]*hit[s-support[i]];
+        }
+        hit[s] = probability;
+    }
+    if (not (hit[window] > 0))
+    {
+        throw invalid_argument(
+                "No sequence drawn from the distribution has the same sum.");
+    }
+    //largest hitting probability where the unconditioned prefix enters the
+    //window
+    double largest_hit = 0;
+    for (unsigned long long r = window - min(window, largest) + 1;
+            r <= window; r++)
+    {
+        largest_hit = max(largest_hit, hit[r]);
+    }
+    AliasSampler nonzero_sampler(weight);
+
+    //zeros between non-zero values are geometrically distributed, with
+    //0 < zero_probability < 1 here since the support is not empty
+    double zero_probability = zero_weight/(zero_weight + nonzero_weight);
+    geometric_distribution<unsigned int> zeros(
+            zero_probability > 0 ? 1 - zero_probability : 1.);
+
+    for (unsigned int attempt = 0; attempt < max_attempts; attempt++)
+    {
+        //above the window, the conditioned prefix has the unconditioned law
+        //tilted by hit[remaining] at the entry in the window: draw it freely
+        //and accept with probability hit[remaining]/largest_hit
+        vector<unsigned int> values;
+        unsigned long long remaining = scaled_total;
+        while (remaining > window)
+        {
+            values.clear();
+            remaining = scaled_total;
+            while (remaining > window)
+            {
+                values.push_back(support[nonzero_sampler(gen)]);
+                remaining -= values.back();
+            }
+            double u = generate_canonical<double,
+                numeric_limits<double>::digits>(gen)*largest_hit;
+            if (u >= hit[remaining])
+            {
+                remaining = scaled_total;
+            }
+        }
+
+        //inside the window, the exact renewal dynamic
+        while (remaining > 0)
+        {
+            //next value k with probability w[k]*hit[remaining-k]/hit[remaining]
+            double u = generate_canonical<double,
+                numeric_limits<double>::digits>(gen)*hit[remaining];
+            size_t i = 0;
+            unsigned int value = 0;
+            for (; i < support.size() and support[i] <= remaining; i++)
+            {
+                double probability = weight[i]*hit[remaining-support[i]];
+                if (probability > 0)
+                {
+                    value = support[i];
+                    if (u < probability)
+                    {
+                        break;
+                    }
+                    u -= probability;
+                }
+            }
+            values.push_back(value);
+            remaining -= value;
+        }
+
+        vector<unsigned int> seq_2;
+        seq_2.reserve(values.size());
+        for (unsigned int value : values)
+        {
+            if (zero_probability > 0)
+            {
+                seq_2.insert(seq_2.end(), zeros(gen), 0);
+            }
+            seq_2.push_back(value*period);
+        }
+
+        if (not ensure_bigraphic)
+        {
+            return seq_2;
+        }
+        try
+        {
+            BipartiteConfigurationModelSampler::is_bigraphic(seq_1, seq_2);
+            return seq_2;
+        }
+        catch (invalid_argument&)
+        {
+            //draw again
+        }
+    }
+    throw runtime_error("No bigraphic sequence found in the given number of "
+            "attempts.");
+}
+
+}//end of namespace horgg
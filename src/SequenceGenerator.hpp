@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef SEQUENCE_GENERATOR_HPP_
+#define SEQUENCE_GENERATOR_HPP_
+
+#include "GraphGenerator.hpp"
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Walker/Vose alias table to draw values 0, 1, ..., size-1 with probability
+ * proportional to the given weights in constant time.
+ */
+class AliasSampler
+{
+public:
+    explicit AliasSampler(const std::vector<double>& weights);
+
+    unsigned int operator()(RNGType& gen) const
+    {
+        double u = std::generate_canonical<double,
+            std::numeric_limits<double>::digits>(gen)*probability_.size();
+        unsigned int index = u;
+        if (index == probability_.size())
+        {
+            index -= 1;
+        }
+        return (u - index < probability_[index]) ? index : alias_[index];
+    }
+
+    std::size_t size() const {return probability_.size();}
+
+private:
+    std::vector<double> probability_;
+    std::vector<unsigned int> alias_;
+};
+
+//fill sequence[0..size) with values distributed according to dist
+void sequence_1(unsigned int* sequence, std::size_t size,
+        const std::vector<double>& dist, RNGType& gen);
+
+std::vector<unsigned int> sequence_1(std::size_t size,
+        const std::vector<double>& dist, RNGType& gen);
+
+//values distributed according to dist, drawn until their sum is the sum of
+//seq_1 (overshooting entries are removed at random). The loop never ends if
+//the sum cannot be reached; with max_iterations > 0, std::runtime_error is
+//thrown after that many appends and removals.
+std::vector<unsigned int> sequence_2(const std::vector<unsigned int>& seq_1,
+        const std::vector<double>& dist, RNGType& gen,
+        std::size_t max_iterations=0);
+
+//values distributed according to dist, conditioned on the first partial sum
+//reaching the sum of seq_1 being exactly that sum. This is the distribution
+//sequence_2 aims at, sampled exactly instead of with the append/pop loop: a
+//renewal dynamic program over a window of remaining sums, whose size does
+//not depend on the sum of seq_1, gives the exact law near the end, and the
+//prefix above the window is drawn freely and accepted by rejection. With
+//the non-zero values of dist divided by their gcd, the window has
+//W = max(2*max, (min-1)*(max-1) + max) entries (at most the sum), built in
+//O(W*|support|), after which a sequence takes expected time linear in its
+//length. Throws std::invalid_argument if W*|support| exceeds 2^27 (wide
+//and sparse supports, use sequence_2 instead). A distribution with only
+//the value 0 gives the empty sequence if seq_1 sums to 0. With
+//ensure_bigraphic, the sequence is redrawn (at most max_attempts times)
+//until it is bigraphic with seq_1.
+std::vector<unsigned int> sequence_2_exact(
+        const std::vector<unsigned int>& seq_1,
+        const std::vector<double>& dist, RNGType& gen,
+        bool ensure_bigraphic=false, unsigned int max_attempts=100);
+
+}//end of namespace horgg
+
+#endif /* SEQUENCE_GENERATOR_HPP_ */
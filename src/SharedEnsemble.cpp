@@ -0,0 +1,330 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "SharedEnsemble.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+static_assert(sizeof(SharedEnsembleHeader) == 64,
+        "the shared ensemble header must be 64 bytes");
+static_assert(sizeof(pair<Node,Group>) == 2*sizeof(uint32_t),
+        "edges must be stored as contiguous pairs of uint32");
+static_assert(ATOMIC_INT_LOCK_FREE == 2 and ATOMIC_LLONG_LOCK_FREE == 2,
+        "the header counters must be lock-free to be shared between processes");
+
+namespace
+{//start of anonymous namespace
+
+//how long a reader waits for a segment being created to be published
+const chrono::milliseconds SEGMENT_READY_TIMEOUT(1000);
+
+//largest segment that ftruncate and mmap can represent
+const uint64_t MAX_SEGMENT_SIZE = uint64_t(numeric_limits<off_t>::max());
+
+//true if the header and capacity graphs of nb_edges edges fit in size bytes,
+//without overflowing
+bool graphs_fit(uint64_t capacity, uint64_t nb_edges, uint64_t size)
+{
+    if (size < sizeof(SharedEnsembleHeader))
+    {
+        return false;
+    }
+    uint64_t graph_size = 2*sizeof(uint32_t);
+    if (nb_edges > (size - sizeof(SharedEnsembleHeader))/graph_size)
+    {
+        return false;
+    }
+    graph_size *= nb_edges;
+    return graph_size == 0
+        or capacity <= (size - sizeof(SharedEnsembleHeader))/graph_size;
+}
+
+//error of a failed system call on the segment, with the reason from errno
+runtime_error segment_error(const string& message, const string& name,
+        int error)
+{
+    return runtime_error(message + " " + name + ": " + strerror(error));
+}
+
+}//end of anonymous namespace
+
+/* =================
+ * SharedEnsembleWriter
+ * ================= */
+
+SharedEnsembleWriter::SharedEnsembleWriter(const string& name,
+        const MembershipSequence& membership_sequence,
+        const GroupSizeSequence& group_size_sequence,
+        size_t capacity, uint64_t seed):
+    header_(nullptr),
+    graphs_(nullptr),
+    segment_size_(0),
+    nb_edges_(accumulate(membership_sequence.begin(),
+                membership_sequence.end(), uint64_t(0))),
+    capacity_(capacity)
+{
+    if (not graphs_fit(capacity_, nb_edges_, MAX_SEGMENT_SIZE))
+    {
+        throw invalid_argument("Capacity is too large for a shared memory "
+                "segment.");
+    }
+    segment_size_ = sizeof(SharedEnsembleHeader)
+        + capacity_*nb_edges_*2*sizeof(uint32_t);
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        throw segment_error("Cannot create shared memory segment", name,
+                errno);
+    }
+    if (ftruncate(fd, segment_size_) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        throw segment_error("Cannot allocate shared memory segment", name,
+                error);
+    }
+    void* data = mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        throw segment_error("Cannot map shared memory segment", name, error);
+    }
+
+    //the segment is zero-filled, so the version stays 0 until it is published
+    header_ = new (data) SharedEnsembleHeader;
+    memcpy(header_->magic, SHARED_ENSEMBLE_MAGIC,
+            sizeof(SHARED_ENSEMBLE_MAGIC));
+    header_->reserved = 0;
+    header_->seed = seed;
+    header_->nb_nodes = membership_sequence.size();
+    header_->nb_groups = group_size_sequence.size();
+    header_->nb_edges = nb_edges_;
+    header_->capacity = capacity_;
+    header_->nb_graphs.store(0, memory_order_relaxed);
+    graphs_ = reinterpret_cast<uint32_t*>(header_+1);
+    header_->version.store(SHARED_ENSEMBLE_VERSION, memory_order_release);
+}
+
+SharedEnsembleWriter::~SharedEnsembleWriter()
+{
+    close();
+}
+
+void SharedEnsembleWriter::write(const EdgeList& edge_list)
+{
+    if (header_ == nullptr)
+    {
+        throw runtime_error("Shared ensemble is closed.");
+    }
+    if (edge_list.size() != nb_edges_)
+    {
+        throw invalid_argument("The graph has the wrong number of edges.");
+    }
+    uint64_t nb_graphs = header_->nb_graphs.load(memory_order_relaxed);
+    if (nb_graphs == capacity_)
+    {
+        throw runtime_error("Shared ensemble is full.");
+    }
+    trace::Span span("shared_ensemble_write");
+    memcpy(graphs_ + nb_graphs*nb_edges_*2, edge_list.data(),
+            nb_edges_*2*sizeof(uint32_t));
+    header_->nb_graphs.store(nb_graphs+1, memory_order_release);
+}
+
+void SharedEnsembleWriter::write_random_graphs(
+        BipartiteConfigurationModelSampler& sampler, size_t nb_graphs,
+        unsigned int nb_steps)
+{
+    for (size_t i = 0; i < nb_graphs; i++)
+    {
+        write(sampler.get_random_graph(nb_steps));
+    }
+}
+
+void SharedEnsembleWriter::close()
+{
+    if (header_ != nullptr)
+    {
+        munmap(header_, segment_size_);
+        header_ = nullptr;
+        graphs_ = nullptr;
+    }
+}
+
+uint64_t SharedEnsembleWriter::size() const
+{
+    if (header_ == nullptr)
+    {
+        throw runtime_error("Shared ensemble is closed.");
+    }
+    return header_->nb_graphs.load(memory_order_relaxed);
+}
+
+void SharedEnsembleWriter::unlink(const string& name)
+{
+    if (shm_unlink(name.c_str()) != 0)
+    {
+        throw segment_error("Cannot unlink shared memory segment", name,
+                errno);
+    }
+}
+
+/* =================
+ * SharedEnsembleReader
+ * ================= */
+
+SharedEnsembleReader::SharedEnsembleReader(const string& name):
+    header_(nullptr),
+    graphs_(nullptr),
+    segment_size_(0)
+{
+    //a segment being created may still be empty or unpublished
+    Clock::time_point deadline = Clock::now() + SEGMENT_READY_TIMEOUT;
+    chrono::microseconds delay(10);
+    uint32_t version = 0;
+    while (true)
+    {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        {
+            throw segment_error("Cannot open shared memory segment", name,
+                    errno);
+        }
+        struct stat segment_stat;
+        if (fstat(fd, &segment_stat) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            throw segment_error("Cannot open shared memory segment", name,
+                    error);
+        }
+        segment_size_ = segment_stat.st_size;
+        if (segment_size_ >= sizeof(SharedEnsembleHeader))
+        {
+            void* data = mmap(nullptr, segment_size_, PROT_READ, MAP_SHARED,
+                    fd, 0);
+            int error = errno;
+            ::close(fd);
+            if (data == MAP_FAILED)
+            {
+                throw segment_error("Cannot map shared memory segment", name,
+                        error);
+            }
+            header_ = static_cast<const SharedEnsembleHeader*>(data);
+            version = header_->version.load(memory_order_acquire);
+            if (version != 0)
+            {
+                break;
+            }
+            munmap(const_cast<SharedEnsembleHeader*>(header_), segment_size_);
+            header_ = nullptr;
+        }
+        else
+        {
+            ::close(fd);
+        }
+        if (Clock::now() >= deadline)
+        {
+            throw runtime_error(name + " is not a shared ensemble.");
+        }
+        this_thread::sleep_for(delay);
+        delay = min(delay*2, chrono::microseconds(10000));
+    }
+    graphs_ = reinterpret_cast<const uint32_t*>(header_+1);
+
+    if (memcmp(header_->magic, SHARED_ENSEMBLE_MAGIC,
+                sizeof(SHARED_ENSEMBLE_MAGIC)) != 0
+            or version != SHARED_ENSEMBLE_VERSION
+            or not graphs_fit(header_->capacity, header_->nb_edges,
+                segment_size_))
+    {
+        munmap(const_cast<SharedEnsembleHeader*>(header_), segment_size_);
+        throw runtime_error(name + " is not a shared ensemble.");
+    }
+}
+
+SharedEnsembleReader::~SharedEnsembleReader()
+{
+    munmap(const_cast<SharedEnsembleHeader*>(header_), segment_size_);
+}
+
+size_t SharedEnsembleReader::size() const
+{
+    return min(header_->nb_graphs.load(memory_order_acquire),
+            header_->capacity);
+}
+
+size_t SharedEnsembleReader::wait(size_t nb_graphs,
+        Clock::duration timeout) const
+{
+    Clock::time_point deadline = Clock::now() + timeout;
+    chrono::microseconds delay(10);
+    size_t available = size();
+    while (available < nb_graphs and Clock::now() < deadline)
+    {
+        this_thread::sleep_for(delay);
+        delay = min(delay*2, chrono::microseconds(10000));
+        available = size();
+    }
+    return available;
+}
+
+const uint32_t* SharedEnsembleReader::raw_graph(size_t index) const
+{
+    if (index >= size())
+    {
+        throw out_of_range("Graph index out of range.");
+    }
+    return graphs_ + index*header_->nb_edges*2;
+}
+
+EdgeList SharedEnsembleReader::get_graph(size_t index) const
+{
+    const uint32_t* edges = raw_graph(index);
+    const pair<Node,Group>* first =
+        reinterpret_cast<const pair<Node,Group>*>(edges);
+    return EdgeList(first, first + header_->nb_edges);
+}
+
+}//end of namespace horgg
@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef SHARED_ENSEMBLE_HPP_
+#define SHARED_ENSEMBLE_HPP_
+
+#include "GraphGenerator.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Ensemble of raw graphs in a POSIX shared-memory segment, for consumers in
+ * other processes on the same node.
+ *
+ * Layout (native byte order):
+ *   header   magic "HORGGSHM", version, seed, number of nodes, groups, edges,
+ *            capacity (maximal number of graphs) and the number of graphs
+ *            written so far, 64 bytes in total
+ *   graphs   capacity slots of nb_edges (node, group) uint32 pairs
+ *
+ * The version is stored (release) once the rest of the header is written and
+ * stays 0 until then, so a reader that opens the segment while it is being
+ * created retries until the version is published (acquire) or a short
+ * timeout expires. The number of graphs is an atomic counter incremented
+ * (release) after a graph is copied, so a reader that loads it (acquire) can
+ * use every graph below it while the writer keeps appending. The segment
+ * outlives the writer and the readers until it is unlinked.
+ */
+
+const char SHARED_ENSEMBLE_MAGIC[8] = {'H','O','R','G','G','S','H','M'};
+const std::uint32_t SHARED_ENSEMBLE_VERSION = 1;
+
+struct SharedEnsembleHeader
+{
+    char magic[8];
+    std::atomic<std::uint32_t> version;
+    std::uint32_t reserved;
+    std::uint64_t seed;
+    std::uint64_t nb_nodes;
+    std::uint64_t nb_groups;
+    std::uint64_t nb_edges;
+    std::uint64_t capacity;
+    std::atomic<std::uint64_t> nb_graphs;
+};
+
+//creates the segment, which must not exist, and appends graphs to it
+class SharedEnsembleWriter
+{
+public:
+    SharedEnsembleWriter(const std::string& name,
+            const MembershipSequence& membership_sequence,
+            const GroupSizeSequence& group_size_sequence,
+            std::size_t capacity, std::uint64_t seed);
+    ~SharedEnsembleWriter();
+
+    SharedEnsembleWriter(const SharedEnsembleWriter&) = delete;
+    SharedEnsembleWriter& operator=(const SharedEnsembleWriter&) = delete;
+
+    void write(const EdgeList& edge_list);
+
+    //append nb_graphs random graphs drawn with sampler.get_random_graph
+    void write_random_graphs(BipartiteConfigurationModelSampler& sampler,
+            std::size_t nb_graphs, unsigned int nb_steps=0);
+
+    //unmap the segment; the graphs stay available to the readers
+    void close();
+
+    std::uint64_t size() const;
+    std::uint64_t get_capacity() const {return capacity_;}
+
+    //remove the name of a segment; it is freed once no longer mapped
+    static void unlink(const std::string& name);
+
+private:
+    SharedEnsembleHeader* header_;
+    std::uint32_t* graphs_;
+    std::size_t segment_size_;
+    std::uint64_t nb_edges_;
+    std::uint64_t capacity_;
+};
+
+//read-only attachment to a segment, possibly while it is being written
+class SharedEnsembleReader
+{
+public:
+    explicit SharedEnsembleReader(const std::string& name);
+    ~SharedEnsembleReader();
+
+    SharedEnsembleReader(const SharedEnsembleReader&) = delete;
+    SharedEnsembleReader& operator=(const SharedEnsembleReader&) = delete;
+
+    //number of graphs available now
+    std::size_t size() const;
+    std::uint64_t get_capacity() const {return header_->capacity;}
+    std::uint64_t get_seed() const {return header_->seed;}
+    std::uint64_t get_nb_nodes() const {return header_->nb_nodes;}
+    std::uint64_t get_nb_groups() const {return header_->nb_groups;}
+    std::uint64_t get_nb_edges() const {return header_->nb_edges;}
+
+    //wait until at least nb_graphs graphs are available or the timeout
+    //expires; returns the number of graphs available
+    std::size_t wait(std::size_t nb_graphs, Clock::duration timeout) const;
+
+    //pointer to the (node, group) pairs of graph index, inside the segment
+    const std::uint32_t* raw_graph(std::size_t index) const;
+    EdgeList get_graph(std::size_t index) const;
+
+private:
+    const SharedEnsembleHeader* header_;
+    const std::uint32_t* graphs_;
+    std::size_t segment_size_;
+};
+
+}//end of namespace horgg
+
+#endif /* SHARED_ENSEMBLE_HPP_ */
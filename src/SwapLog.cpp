@@ -0,0 +1,274 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "SwapLog.hpp"
+#include "Trace.hpp"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+namespace
+{//start of anonymous namespace
+
+const char SWAP_LOG_MAGIC[8] = {'H','O','R','G','G','L','O','G'};
+const uint32_t SWAP_LOG_VERSION = 1;
+
+template <typename T>
+void write_array(FILE* file, const T* data, size_t size)
+{
+    uint64_t nb_elements = size;
+    if (fwrite(&nb_elements, sizeof(nb_elements), 1, file) != 1
+            or fwrite(data, sizeof(T), size, file) != size)
+    {
+        throw runtime_error("Cannot write swap log file.");
+    }
+}
+
+//closes the file on every exit path
+typedef unique_ptr<FILE, decltype(&fclose)> FilePointer;
+
+FilePointer open_file(const string& path, const char* mode)
+{
+    FilePointer file(fopen(path.c_str(), mode), &fclose);
+    if (not file)
+    {
+        throw runtime_error("Cannot open " + path);
+    }
+    return file;
+}
+
+//the size is checked against the bytes left in a file of file_size bytes
+//before anything is allocated
+template <typename T>
+void read_array(FILE* file, uint64_t file_size, vector<T>& data)
+{
+    uint64_t nb_elements;
+    if (fread(&nb_elements, sizeof(nb_elements), 1, file) != 1)
+    {
+        throw runtime_error("Truncated swap log file.");
+    }
+    long position = ftell(file);
+    if (position < 0 or uint64_t(position) > file_size
+            or nb_elements > (file_size - position)/sizeof(T))
+    {
+        throw runtime_error("Truncated swap log file.");
+    }
+    data.resize(nb_elements);
+    if (fread(data.data(), sizeof(T), nb_elements, file) != nb_elements)
+    {
+        throw runtime_error("Truncated swap log file.");
+    }
+}
+
+}//end of anonymous namespace
+
+SwapLog::SwapLog(size_t keyframe_interval):
+    keyframe_interval_(keyframe_interval),
+    base_(),
+    current_(),
+    swaps_(),
+    snapshot_offset_(),
+    keyframes_()
+{
+}
+
+void SwapLog::on_reset(const EdgeList& edge_list)
+{
+    base_ = edge_list;
+    if (keyframe_interval_ > 0)
+    {
+        current_ = edge_list;
+    }
+    swaps_.clear();
+    snapshot_offset_.clear();
+    keyframes_.clear();
+}
+
+void SwapLog::on_swap(size_t edge1, size_t edge2, Node, Group group1, Node,
+        Group group2)
+{
+    swaps_.push_back(edge1);
+    swaps_.push_back(edge2);
+    if (keyframe_interval_ > 0)
+    {
+        current_[edge1].second = group2;
+        current_[edge2].second = group1;
+    }
+}
+
+void SwapLog::snapshot()
+{
+    if (keyframe_interval_ > 0 and size() % keyframe_interval_ == 0)
+    {
+        keyframes_.push_back(current_);
+    }
+    snapshot_offset_.push_back(get_nb_swaps());
+}
+
+void SwapLog::record(BipartiteConfigurationModelSampler& sampler,
+        size_t nb_snapshots, unsigned int nb_steps)
+{
+    trace::Span span("swap_log_record");
+    sampler.attach(this);
+    for (size_t i = 0; i < nb_snapshots; i++)
+    {
+        if (i > 0)
+        {
+            for (unsigned int j = 0; j < nb_steps; j++)
+            {
+                sampler.mcmc_step();
+            }
+        }
+        snapshot();
+    }
+    sampler.detach(this);
+}
+
+//apply swaps [first, last) of the log to edge_list
+void SwapLog::replay(uint64_t first, uint64_t last, EdgeList& edge_list) const
+{
+    for (uint64_t swap = first; swap < last; swap++)
+    {
+        std::swap(edge_list[swaps_[2*swap]].second,
+                edge_list[swaps_[2*swap+1]].second);
+    }
+}
+
+void SwapLog::materialise(size_t index, EdgeList& edge_list) const
+{
+    trace::Span span("swap_log_materialise");
+    if (index >= size())
+    {
+        throw out_of_range("Snapshot index out of range.");
+    }
+    uint64_t first = 0;
+    if (keyframes_.empty())
+    {
+        edge_list.assign(base_.begin(), base_.end());
+    }
+    else
+    {
+        size_t keyframe = index/keyframe_interval_;
+        edge_list.assign(keyframes_[keyframe].begin(),
+                keyframes_[keyframe].end());
+        first = snapshot_offset_[keyframe*keyframe_interval_];
+    }
+    replay(first, snapshot_offset_[index], edge_list);
+}
+
+EdgeList SwapLog::get_graph(size_t index) const
+{
+    EdgeList edge_list;
+    materialise(index, edge_list);
+    return edge_list;
+}
+
+//binary file: magic, version, base edge list, snapshot offsets and swaps
+void SwapLog::save(const string& path) const
+{
+    FilePointer file = open_file(path, "wb");
+    if (fwrite(SWAP_LOG_MAGIC, sizeof(SWAP_LOG_MAGIC), 1, file.get()) != 1
+            or fwrite(&SWAP_LOG_VERSION, sizeof(SWAP_LOG_VERSION), 1,
+                file.get()) != 1)
+    {
+        throw runtime_error("Cannot write swap log file.");
+    }
+    write_array(file.get(), base_.data(), base_.size());
+    write_array(file.get(), snapshot_offset_.data(), snapshot_offset_.size());
+    write_array(file.get(), swaps_.data(), swaps_.size());
+    if (fclose(file.release()) != 0)
+    {
+        throw runtime_error("Cannot write swap log file.");
+    }
+}
+
+SwapLog SwapLog::load(const string& path, size_t keyframe_interval)
+{
+    FilePointer file = open_file(path, "rb");
+    long file_size = -1;
+    if (fseek(file.get(), 0, SEEK_END) == 0)
+    {
+        file_size = ftell(file.get());
+    }
+    if (file_size < 0 or fseek(file.get(), 0, SEEK_SET) != 0)
+    {
+        throw runtime_error("Cannot read " + path);
+    }
+    SwapLog log(keyframe_interval);
+    EdgeList base;
+    vector<uint64_t> snapshot_offset;
+    vector<uint32_t> swaps;
+    char magic[sizeof(SWAP_LOG_MAGIC)];
+    uint32_t version;
+    if (fread(magic, sizeof(magic), 1, file.get()) != 1
+            or memcmp(magic, SWAP_LOG_MAGIC, sizeof(magic)) != 0
+            or fread(&version, sizeof(version), 1, file.get()) != 1
+            or version != SWAP_LOG_VERSION)
+    {
+        throw runtime_error(path + " is not a swap log file.");
+    }
+    read_array(file.get(), file_size, base);
+    read_array(file.get(), file_size, snapshot_offset);
+    read_array(file.get(), file_size, swaps);
+    file.reset();
+
+    //validate and rebuild the keyframes by replaying the log
+    for (uint32_t edge : swaps)
+    {
+        if (edge >= base.size())
+        {
+            throw runtime_error(path + " is corrupted.");
+        }
+    }
+    log.on_reset(base);
+    log.swaps_.swap(swaps);
+    uint64_t previous = 0;
+    for (uint64_t offset : snapshot_offset)
+    {
+        if (offset < previous or offset > log.get_nb_swaps())
+        {
+            throw runtime_error(path + " is corrupted.");
+        }
+        if (keyframe_interval > 0)
+        {
+            log.replay(previous, offset, log.current_);
+            if (log.size() % keyframe_interval == 0)
+            {
+                log.keyframes_.push_back(log.current_);
+            }
+        }
+        log.snapshot_offset_.push_back(offset);
+        previous = offset;
+    }
+    return log;
+}
+
+}//end of namespace horgg
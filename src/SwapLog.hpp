@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef SWAP_LOG_HPP_
+#define SWAP_LOG_HPP_
+
+#include "GraphGenerator.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace horgg
+{//start of namespace horgg
+
+/*
+ * Compact record of a thinned chain. Only the first graph is stored in full;
+ * every later snapshot is the list of accepted swaps (pairs of edge indices
+ * whose groups are exchanged) since the previous one. Optional keyframes
+ * (full copies every keyframe_interval snapshots) bound the replay cost of
+ * random access.
+ */
+class SwapLog : public SwapObserver
+{
+public:
+    explicit SwapLog(std::size_t keyframe_interval=0);
+
+    //observer interface -- a reset starts a new log from the given graph
+    void on_reset(const EdgeList& edge_list);
+    void on_swap(std::size_t edge1, std::size_t edge2,
+            Node node1, Group group1, Node node2, Group group2);
+
+    //mark the current state of the followed chain as a snapshot
+    void snapshot();
+
+    //record nb_snapshots snapshots of the chain of `sampler`, starting with
+    //its current graph and separated by nb_steps mcmc steps
+    void record(BipartiteConfigurationModelSampler& sampler,
+            std::size_t nb_snapshots, unsigned int nb_steps);
+
+    std::size_t size() const {return snapshot_offset_.size();}
+    std::size_t get_nb_swaps() const {return swaps_.size()/2;}
+    std::size_t get_nb_edges() const {return base_.size();}
+
+    //write snapshot `index` in `edge_list` (resized to the number of edges)
+    void materialise(std::size_t index, EdgeList& edge_list) const;
+    EdgeList get_graph(std::size_t index) const;
+
+    void save(const std::string& path) const;
+    static SwapLog load(const std::string& path,
+            std::size_t keyframe_interval=0);
+
+private:
+    std::size_t keyframe_interval_;
+    EdgeList base_;
+    //current state, kept to build the keyframes
+    EdgeList current_;
+    //pairs of edge indices, flattened
+    std::vector<std::uint32_t> swaps_;
+    //number of swaps preceding each snapshot
+    std::vector<std::uint64_t> snapshot_offset_;
+    std::vector<EdgeList> keyframes_;
+
+    void replay(std::uint64_t first, std::uint64_t last,
+            EdgeList& edge_list) const;
+};
+
+}//end of namespace horgg
+
+#endif /* SWAP_LOG_HPP_ */
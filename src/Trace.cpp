@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Trace.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+using namespace std;
+
+namespace horgg
+{//start of namespace horgg
+
+namespace trace
+{//start of namespace trace
+
+namespace
+{//start of anonymous namespace
+
+struct Event
+{
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+struct ThreadBuffer
+{
+    mutex buffer_mutex;
+    vector<Event> events;
+    unsigned int tid;
+};
+
+//buffers are shared with the registry so they outlive their thread
+mutex registry_mutex;
+vector<shared_ptr<ThreadBuffer> > registry;
+
+const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+ThreadBuffer& local_buffer()
+{
+    thread_local shared_ptr<ThreadBuffer> buffer;
+    if (not buffer)
+    {
+        buffer = make_shared<ThreadBuffer>();
+        lock_guard<mutex> lock(registry_mutex);
+        buffer->tid = registry.size();
+        registry.push_back(buffer);
+    }
+    return *buffer;
+}
+
+//copy of all recorded spans, grouped by thread
+vector<pair<unsigned int, vector<Event> > > collect()
+{
+    vector<pair<unsigned int, vector<Event> > > snapshot;
+    lock_guard<mutex> lock(registry_mutex);
+    for (auto& buffer : registry)
+    {
+        lock_guard<mutex> buffer_lock(buffer->buffer_mutex);
+        snapshot.emplace_back(buffer->tid, buffer->events);
+    }
+    return snapshot;
+}
+
+FILE* open_output(const string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        throw runtime_error("Cannot open trace output file " + path);
+    }
+    return file;
+}
+
+bool enabled_from_environment()
+{
+    const char* value = getenv("HORGG_TRACE");
+    return value != nullptr and value[0] != '\0' and string(value) != "0";
+}
+
+}//end of anonymous namespace
+
+atomic<bool> enabled_(enabled_from_environment());
+
+void enable()
+{
+    enabled_.store(true, memory_order_relaxed);
+}
+
+void disable()
+{
+    enabled_.store(false, memory_order_relaxed);
+}
+
+//drop all recorded spans
+void clear()
+{
+    lock_guard<mutex> lock(registry_mutex);
+    for (auto& buffer : registry)
+    {
+        lock_guard<mutex> buffer_lock(buffer->buffer_mutex);
+        buffer->events.clear();
+    }
+}
+
+uint64_t now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - epoch).count();
+}
+
+void record(const char* name, uint64_t start, uint64_t end)
+{
+    ThreadBuffer& buffer = local_buffer();
+    lock_guard<mutex> lock(buffer.buffer_mutex);
+    buffer.events.push_back({name, start, end});
+}
+
+//complete events ("ph":"X") readable by chrome://tracing and Perfetto
+void dump_chrome_trace(const string& path)
+{
+    FILE* file = open_output(path);
+    int pid = getpid();
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (auto& thread_events : collect())
+    {
+        for (auto& event : thread_events.second)
+        {
+            fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"horgg\",\"ph\":\"X\","
+                    "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+                    first ? "" : ",", event.name, event.start/1000.,
+                    (event.end - event.start)/1000., pid,
+                    thread_events.first);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+}
+
+//one "tid start duration name" line per span, times in nanoseconds since
+//the trace epoch
+void dump_span_log(const string& path)
+{
+    FILE* file = open_output(path);
+    for (auto& thread_events : collect())
+    {
+        for (auto& event : thread_events.second)
+        {
+            fprintf(file, "%u %llu %llu %s\n", thread_events.first,
+                    (unsigned long long) event.start,
+                    (unsigned long long) (event.end - event.start),
+                    event.name);
+        }
+    }
+    fclose(file);
+}
+
+}//end of namespace trace
+
+}//end of namespace horgg
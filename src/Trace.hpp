@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace horgg
+{//start of namespace horgg
+
+namespace trace
+{//start of namespace trace
+
+/*
+ * Lightweight phase tracing. Spans are recorded in per-thread buffers only
+ * when tracing is enabled at runtime (or with the HORGG_TRACE environment
+ * variable), otherwise a span costs a single relaxed atomic load.
+ */
+
+extern std::atomic<bool> enabled_;
+
+inline bool enabled() {return enabled_.load(std::memory_order_relaxed);}
+
+void enable();
+void disable();
+void clear();
+
+//time in nanoseconds since the trace epoch
+std::uint64_t now();
+
+//store a completed span in the buffer of the calling thread
+void record(const char* name, std::uint64_t start, std::uint64_t end);
+
+//output the recorded spans
+void dump_chrome_trace(const std::string& path);
+void dump_span_log(const std::string& path);
+
+//scoped span -- the name must be a string literal (or outlive the trace)
+class Span
+{
+public:
+    explicit Span(const char* name):
+        name_(name), active_(enabled()), start_(active_ ? now() : 0) {}
+
+    ~Span()
+    {
+        if (active_)
+        {
+            record(name_, start_, now());
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    bool active_;
+    std::uint64_t start_;
+};
+
+}//end of namespace trace
+
+}//end of namespace horgg
+
+#endif /* TRACE_HPP_ */
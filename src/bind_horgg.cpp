@@ -24,13 +24,145 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include "GraphGenerator.hpp"
+#include "EnsembleIO.hpp"
+#include "Hyperedges.hpp"
+#include "GroupStatistics.hpp"
+#include "Convergence.hpp"
+#include "Incidence.hpp"
+#include "JointDegree.hpp"
+#include "MetropolisHastings.hpp"
+#include "Pipeline.hpp"
+#include "Prefetcher.hpp"
+#include "SequenceGenerator.hpp"
+#include "SharedEnsemble.hpp"
+#include "SwapLog.hpp"
+#include "Trace.hpp"
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
 
 using namespace std;
 using namespace horgg;
 
 namespace py = pybind11;
 
+//copy an edge list into a (nb_edges, 2) array of (node, group) pairs
+py::array_t<uint32_t> edge_array(const EdgeList& edge_list)
+{
+    py::array_t<uint32_t> edges({py::ssize_t(edge_list.size()),
+            py::ssize_t(2)});
+    copy(edge_list.begin(), edge_list.end(),
+            reinterpret_cast<pair<Node,Group>*>(edges.mutable_data()));
+    return edges;
+}
+
+//move a vector into a 1D array without copying
+template <typename T>
+py::array_t<T> vector_array(vector<T>&& data)
+{
+    vector<T>* owned = new vector<T>(move(data));
+    py::capsule owner(owned, [](void* pointer)
+        {
+            delete static_cast<vector<T>*>(pointer);
+        });
+    return py::array_t<T>(owned->size(), owned->data(), owner);
+}
+
+//array over a buffer of `base` (read-only view, valid while the buffer is),
+//or a copy of it
+template <typename T>
+py::array_t<T> buffer_array(const vector<T>& data, py::handle base, bool copy)
+{
+    if (copy)
+    {
+        return py::array_t<T>(data.size(), data.data());
+    }
+    py::array_t<T> view(data.size(), data.data(), base);
+    view.attr("setflags")(py::arg("write") = false);
+    return view;
+}
+
+typedef py::array_t<unsigned int, py::array::c_style | py::array::forcecast>
+    SequenceArray;
+
+//fill a vector with the raw bytes of a contiguous buffer
+template <typename T>
+void copy_buffer(py::handle buffer, vector<T>& data)
+{
+    py::buffer_info info = py::reinterpret_borrow<py::buffer>(buffer)
+        .request();
+    py::ssize_t stride = info.itemsize;
+    for (py::ssize_t dim = info.ndim-1; dim >= 0; dim--)
+    {
+        if (info.shape[dim] > 1 and info.strides[dim] != stride)
+        {
+            throw invalid_argument("Sampler state buffers must be "
+                    "contiguous.");
+        }
+        stride *= info.shape[dim];
+    }
+    size_t size = info.size*info.itemsize;
+    if (size % sizeof(T) != 0)
+    {
+        throw invalid_argument("Invalid sampler state.");
+    }
+    data.resize(size/sizeof(T));
+    memcpy(data.data(), info.ptr, size);
+}
+
+//threads of the asyncio front end, never destroyed so that no task is left
+//waiting for the GIL during the interpreter shutdown
+TaskPool& async_pool()
+{
+    static TaskPool* pool = new TaskPool();
+    return *pool;
+}
+
+//cancellation flag shared between Python and a running task
+struct CancellationToken
+{
+    shared_ptr<atomic<bool> > cancelled;
+    void cancel() {*cancelled = true;}
+};
+
+//flags of the tasks of the asyncio front end that are not finished yet,
+//never destroyed for the same reason as the pool
+struct PendingTasks
+{
+    mutex lock;
+    set<shared_ptr<atomic<bool> > > flags;
+};
+
+PendingTasks& pending_tasks()
+{
+    static PendingTasks* pending = new PendingTasks();
+    return *pending;
+}
+
+//called at exit, so that the workers stop before the interpreter shuts down
+void cancel_pending_tasks()
+{
+    PendingTasks& pending = pending_tasks();
+    lock_guard<mutex> guard(pending.lock);
+    for (auto& flag : pending.flags)
+    {
+        *flag = true;
+    }
+}
+
+bool python_is_finalizing()
+{
+#if PY_VERSION_HEX >= 0x030D0000
+    return Py_IsFinalizing();
+#else
+    return _Py_IsFinalizing();
+#endif
+}
+
 
 PYBIND11_MODULE(_horgg, m)
 {
@@ -47,6 +179,24 @@ PYBIND11_MODULE(_horgg, m)
             )pbdoc", py::arg("membership_sequence"),
                 py::arg("group_size_sequence"))
 
+        .def(py::init([](vector<unsigned int> membership_sequence,
+                        vector<unsigned int> group_size_sequence,
+                        unsigned long long seed)
+            {
+                return new BipartiteConfigurationModelSampler(
+                        membership_sequence, group_size_sequence,
+                        RNGType(seed));
+            }), R"pbdoc(
+            Constructor of the class BCMS with its own RNG instead of the one
+            shared by all BCMS objects.
+
+            Args:
+               membership_sequence: Sequence of membership
+               group_size_sequence: Sequence of group size
+               seed: Seed of the RNG of this sampler.
+            )pbdoc", py::arg("membership_sequence"),
+                py::arg("group_size_sequence"), py::arg("seed"))
+
         .def(py::init<EdgeList>(), R"pbdoc(
             Constructor of the class BCMS when an edge list.
 
@@ -54,6 +204,72 @@ PYBIND11_MODULE(_horgg, m)
                edge_list: Edge list for the bipartite graph.
             )pbdoc", py::arg("edge_list"))
 
+        .def(py::init<EdgeList, vector<uint8_t> >(), R"pbdoc(
+            Constructor of the class BCMS with an edge list, of which some
+            edges are never moved.
+
+            Args:
+               edge_list: Edge list for the bipartite graph.
+               frozen: Sequence of booleans, True for the edges to keep.
+            )pbdoc", py::arg("edge_list"), py::arg("frozen"))
+
+        .def("set_frozen_edges",
+                &BipartiteConfigurationModelSampler::set_frozen_edges,
+                R"pbdoc(
+            Keep some edges of the current graph fixed: swaps are only
+            proposed among the other edges, and the stub matching of
+            get_random_graph only rematches their stubs, without reordering
+            the edges.
+
+            Args:
+               frozen: Sequence of booleans, True for the edges to keep, in
+                       the order of get_graph() (empty to free every edge).
+            )pbdoc", py::arg("frozen"))
+
+        .def("set_classes", &BipartiteConfigurationModelSampler::set_classes,
+                R"pbdoc(
+            Restrict the swaps to edges whose nodes have the same class and
+            whose groups have the same class, so that the number of edges
+            between each node class and group class of the current graph is
+            preserved, also by get_random_graph. Proposals are drawn within
+            per-class buckets of edges, so no swap is rejected for crossing
+            classes.
+
+            Args:
+               node_classes: Class of each node (empty for a single class).
+               group_classes: Class of each group (empty for a single class).
+            )pbdoc", py::arg("node_classes") = vector<unsigned int>(),
+                py::arg("group_classes") = vector<unsigned int>())
+
+        .def("preserve_joint_degrees", &preserve_joint_degrees, R"pbdoc(
+            Restrict the swaps so that they preserve the number of edges
+            between nodes of each membership and groups of each size. This
+            is set_classes with the membership and/or group size sequences
+            as classes.
+
+            Args:
+               by_membership: Only exchange groups between edges whose nodes
+                              have the same membership.
+               by_group_size: Only exchange groups of the same size.
+            )pbdoc", py::arg("by_membership") = true,
+                py::arg("by_group_size") = false)
+
+        .def_property_readonly("node_classes",
+                &BipartiteConfigurationModelSampler::get_node_classes)
+
+        .def_property_readonly("group_classes",
+                &BipartiteConfigurationModelSampler::get_group_classes)
+
+        .def_property_readonly("frozen_edges", [](
+                    const BipartiteConfigurationModelSampler& self)
+            {
+                const vector<uint8_t>& frozen = self.get_frozen_edges();
+                return py::array_t<bool>(frozen.size(),
+                        reinterpret_cast<const bool*>(frozen.data()));
+            }, R"pbdoc(
+            Copy of the frozen edge mask (empty if every edge is mobile).
+            )pbdoc")
+
         .def_static("seed", &BaseGenerator::seed, R"pbdoc(
             Seed the RNG with a new value.
 
@@ -61,24 +277,1166 @@ PYBIND11_MODULE(_horgg, m)
                seed_value: New value for the seed of the RNG.
             )pbdoc", py::arg("seed_value"))
 
-        .def("get_graph", &BipartiteConfigurationModelSampler::get_graph,
+        .def_static("get_seed", &BaseGenerator::get_seed, R"pbdoc(
+            Get the last seed value of the RNG.
+            )pbdoc")
+
+        .def("save_state", [](const BipartiteConfigurationModelSampler& self,
+                    string path)
+            {
+                ofstream output(path, ios::binary);
+                if (not output)
+                {
+                    throw runtime_error("Cannot open " + path);
+                }
+                self.save_state(output);
+            }, R"pbdoc(
+            Write a checkpoint of the sampler, including the state of its RNG,
+            so that the chain can be continued identically with load_state.
+
+            Args:
+               path: Output file.
+            )pbdoc", py::arg("path"),
+                py::call_guard<py::gil_scoped_release>())
+
+        .def_static("load_state", [](string path)
+            {
+                ifstream input(path, ios::binary);
+                if (not input)
+                {
+                    throw runtime_error("Cannot open " + path);
+                }
+                return BipartiteConfigurationModelSampler::load_state(input);
+            }, R"pbdoc(
+            Restore a sampler from a checkpoint written by save_state. The
+            restored sampler draws from its own copy of the saved RNG, even
+            if the original used the RNG shared by all BCMS objects, which is
+            left untouched. Checkpoints of older versions, without frozen
+            edges or classes, are restored with every edge mobile and a single
+            class.
+
+            Args:
+               path: Checkpoint file.
+            )pbdoc", py::arg("path"),
+                py::call_guard<py::gil_scoped_release>())
+
+        .def(py::pickle(
+            [](const BipartiteConfigurationModelSampler& self)
+            {
+                ostringstream output;
+                self.save_state(output);
+                return py::bytes(output.str());
+            },
+            [](py::object state)
+            {
+                if (py::isinstance<py::bytes>(state))
+                {
+                    istringstream input(state.cast<string>());
+                    return new BipartiteConfigurationModelSampler(
+                            BipartiteConfigurationModelSampler::load_state(
+                                input));
+                }
+                //(header, edges, node stubs, group stubs, frozen edges, node
+                //classes, group classes) from __reduce_ex__; the last three
+                //are missing from older versions
+                py::tuple parts = state.cast<py::tuple>();
+                if (parts.size() < 4)
+                {
+                    throw runtime_error("Corrupted sampler state.");
+                }
+                string header = parts[0].cast<string>();
+                EdgeList edge_list;
+                vector<Node> node_stub_vector;
+                vector<Group> group_stub_vector;
+                vector<uint8_t> frozen;
+                vector<unsigned int> node_classes;
+                vector<unsigned int> group_classes;
+                copy_buffer(parts[1], edge_list);
+                copy_buffer(parts[2], node_stub_vector);
+                copy_buffer(parts[3], group_stub_vector);
+                if (parts.size() > 4)
+                {
+                    copy_buffer(parts[4], frozen);
+                }
+                if (parts.size() > 6)
+                {
+                    copy_buffer(parts[5], node_classes);
+                    copy_buffer(parts[6], group_classes);
+                }
+                py::gil_scoped_release release;
+                return new BipartiteConfigurationModelSampler(
+                        BipartiteConfigurationModelSampler::from_state(header,
+                            move(edge_list), move(node_stub_vector),
+                            move(group_stub_vector), move(frozen),
+                            move(node_classes), move(group_classes)));
+            }))
+
+        .def("__reduce_ex__", [](py::object self, int protocol)
+            {
+                if (protocol < 5)
+                {
+                    return py::module::import("builtins").attr("object")
+                        .attr("__reduce_ex__")(self, protocol)
+                        .cast<py::tuple>();
+                }
+                auto& sampler = self.cast<BipartiteConfigurationModelSampler&>();
+                py::object pickle_buffer =
+                    py::module::import("pickle").attr("PickleBuffer");
+                const EdgeList& edge_list = sampler.get_graph();
+                py::array_t<uint32_t> edges({py::ssize_t(edge_list.size()),
+                        py::ssize_t(2)},
+                        reinterpret_cast<const uint32_t*>(edge_list.data()),
+                        self);
+                edges.attr("setflags")(py::arg("write") = false);
+                py::tuple state = py::make_tuple(
+                        py::bytes(sampler.get_state_header()),
+                        pickle_buffer(edges),
+                        pickle_buffer(buffer_array(sampler.get_node_stubs(),
+                                self, false)),
+                        pickle_buffer(buffer_array(sampler.get_group_stubs(),
+                                self, false)),
+                        pickle_buffer(buffer_array(sampler.get_frozen_edges(),
+                                self, false)),
+                        pickle_buffer(buffer_array(sampler.get_node_classes(),
+                                self, false)),
+                        pickle_buffer(buffer_array(sampler.get_group_classes(),
+                                self, false)));
+                return py::make_tuple(
+                        py::module::import("copyreg").attr("__newobj__"),
+                        py::make_tuple(self.get_type()), state);
+            }, R"pbdoc(
+            With pickle protocol 5, the edge list, the stub vectors, the
+            frozen edge mask and the classes are passed as PickleBuffer views
+            instead of being serialized. They are only sent out-of-band,
+            without copies, when the caller gives a buffer_callback:
+
+                buffers = []
+                data = pickle.dumps(sampler, protocol=5,
+                                    buffer_callback=buffers.append)
+                restored = pickle.loads(data, buffers=buffers)
+
+            multiprocessing and concurrent.futures never pass one, so samplers
+            sent to their workers are serialized in-band, with copies. The
+            restored sampler draws from its own copy of the saved RNG and
+            leaves the shared RNG untouched, as with load_state.
+            )pbdoc", py::arg("protocol"))
+
+        .def("get_membership_sequence",
+                &BipartiteConfigurationModelSampler::get_membership_sequence,
                 R"pbdoc(
+            Get the number of groups of each node.
+            )pbdoc")
+
+        .def("get_group_size_sequence",
+                &BipartiteConfigurationModelSampler::get_group_size_sequence,
+                R"pbdoc(
+            Get the number of nodes in each group.
+            )pbdoc")
+
+        .def("get_graph", [](BipartiteConfigurationModelSampler& self)
+            {
+                const EdgeList& edge_list = self.get_graph();
+                trace::Span span("python_conversion");
+                return py::cast(edge_list);
+            }, R"pbdoc(
             Get the current graph state.
 
             )pbdoc")
 
-        .def("mcmc_step", &BipartiteConfigurationModelSampler::mcmc_step,
-                R"pbdoc(
-            Make one edge swap if possible.
+        .def("get_projection", [](const BipartiteConfigurationModelSampler&
+                    self, unsigned int nb_threads)
+            {
+                CompressedRows projection;
+                {
+                    py::gil_scoped_release release;
+                    projection = node_projection(self.get_graph(),
+                            self.get_nb_nodes(), self.get_nb_groups(),
+                            nb_threads);
+                }
+                return py::make_tuple(vector_array(move(projection.data)),
+                        vector_array(move(projection.indices)),
+                        vector_array(move(projection.indptr)));
+            }, R"pbdoc(
+            Get the weighted node-to-node projection of the current graph,
+            where the weight of (u,v) is the number of groups shared by u and
+            v. Use scipy.sparse.csr_matrix((data, indices, indptr)) to build
+            the adjacency matrix.
+
+            Args:
+               nb_threads: Number of threads (0 for the hardware concurrency).
+
+            Returns:
+               Tuple (data, indices, indptr) of arrays in CSR format.
+            )pbdoc", py::arg("nb_threads") = 0)
+
+        .def("get_incidence_csr", [](py::object self, bool copy)
+            {
+                const CompressedRows& incidence = self.cast<
+                    BipartiteConfigurationModelSampler&>().get_incidence_csr();
+                return py::make_tuple(
+                        buffer_array(incidence.indices, self, copy),
+                        buffer_array(incidence.indptr, self, copy));
+            }, R"pbdoc(
+            Get the node x group incidence matrix of the current graph in CSR
+            format, computed in O(E) by counting sort. Use
+            scipy.sparse.csr_matrix((np.ones(len(indices)), indices, indptr))
+            to build the matrix.
+
+            Args:
+               copy: If False, return read-only views on internal buffers
+                     that are overwritten by the next call.
+
+            Returns:
+               Tuple (indices, indptr) where indices are groups.
+            )pbdoc", py::arg("copy") = true)
 
+        .def("get_incidence_csc", [](py::object self, bool copy)
+            {
+                const CompressedRows& incidence = self.cast<
+                    BipartiteConfigurationModelSampler&>().get_incidence_csc();
+                return py::make_tuple(
+                        buffer_array(incidence.indices, self, copy),
+                        buffer_array(incidence.indptr, self, copy));
+            }, R"pbdoc(
+            Get the node x group incidence matrix of the current graph in CSC
+            format, computed in O(E) by counting sort. Use
+            scipy.sparse.csc_matrix((np.ones(len(indices)), indices, indptr))
+            to build the matrix.
+
+            Args:
+               copy: If False, return read-only views on internal buffers
+                     that are overwritten by the next call.
+
+            Returns:
+               Tuple (indices, indptr) where indices are nodes.
+            )pbdoc", py::arg("copy") = true)
+
+        .def("get_hyperedges", [](BipartiteConfigurationModelSampler& self)
+            {
+                //own buffers, so that the result does not alias those of
+                //get_incidence_csc
+                CompressedRows incidence;
+                build_incidence(self.get_graph(), self.get_nb_nodes(),
+                        self.get_nb_groups(), false, incidence);
+                return py::make_tuple(vector_array(move(incidence.indptr)),
+                        vector_array(move(incidence.indices)));
+            }, R"pbdoc(
+            Get the nodes of each group of the current graph, computed in
+            O(E): the nodes of group g are nodes[offsets[g]:offsets[g+1]].
+            The arrays own their memory and are not modified by later calls.
+            Use HyperedgeList to keep them updated along the chain.
+
+            Returns:
+               Tuple (offsets, nodes).
             )pbdoc")
 
-        .def("get_random_graph", &BipartiteConfigurationModelSampler::get_random_graph,
-                R"pbdoc(
+        .def("mcmc_step", [](BipartiteConfigurationModelSampler& self,
+                    unsigned int nb_steps)
+            {
+                for (unsigned int i = 0; i < nb_steps; i++)
+                {
+                    self.mcmc_step();
+                }
+            }, R"pbdoc(
+            Make edge swaps along the current chain, without a new stub
+            matching.
+
+            Args:
+               nb_steps: unsigned int for the number of edge swaps to perform
+            )pbdoc", py::arg("nb_steps") = 1)
+
+        .def("get_random_graph", [](BipartiteConfigurationModelSampler& self,
+                    unsigned int nb_steps)
+            {
+                const EdgeList& edge_list = self.get_random_graph(nb_steps);
+                trace::Span span("python_conversion");
+                return py::cast(edge_list);
+            }, R"pbdoc(
             Create a random edge list from the configuration model using
             stub matching and mcmc.
 
             Args:
                nb_steps: unsigned int for the number of edge swaps to perform
-            )pbdoc", py::arg("nb_steps") = 0);
+            )pbdoc", py::arg("nb_steps") = 0)
+
+        .def("get_random_graph_within", [](
+                    BipartiteConfigurationModelSampler& self, double time_budget)
+            {
+                size_t nb_steps;
+                {
+                    py::gil_scoped_release release;
+                    nb_steps = self.get_random_graph_within(
+                            chrono::duration_cast<Clock::duration>(
+                                chrono::duration<double>(time_budget)));
+                }
+                const EdgeList& edge_list = self.get_graph();
+                trace::Span span("python_conversion");
+                return py::make_tuple(py::cast(edge_list), nb_steps);
+            }, R"pbdoc(
+            Create a random edge list with stub matching, then make edge swaps
+            until the time budget is spent. The clock is read after batches
+            of swaps sized from the measured time per swap, so the budget is
+            only exceeded by the time of a few swaps.
+
+            Args:
+               time_budget: Wall-clock budget in seconds.
+
+            Returns:
+               (edge_list, nb_steps) with the number of edge swaps performed.
+
+            Raises:
+               RuntimeError: if the stub matching does not finish in time;
+                             the previous graph is then kept.
+            )pbdoc", py::arg("time_budget"))
+
+        .def("draw_seed", &BipartiteConfigurationModelSampler::draw_seed,
+                R"pbdoc(
+            Draw a 64 bits seed from the RNG of the sampler.
+            )pbdoc")
+
+        .def("iter_random_graphs", [](BipartiteConfigurationModelSampler& self,
+                    size_t nb_graphs, unsigned int nb_steps, size_t prefetch,
+                    unsigned int nb_threads, py::object seed)
+            {
+                unsigned long long seed_value = seed.is_none() ?
+                    self.draw_seed() : seed.cast<unsigned long long>();
+                return new GraphPrefetcher(self, nb_graphs, nb_steps,
+                        prefetch, nb_threads, seed_value);
+            }, R"pbdoc(
+            Iterate over random graphs generated in the background by worker
+            threads, each with a copy of the sampler and its own RNG, while
+            the previous graphs are being used. The graph of the sampler is
+            not modified, but with seed=None the seed is drawn from its RNG,
+            which advances it. close() abandons the graphs being generated
+            within a few thousand swaps.
+
+            Args:
+               nb_graphs: Number of graphs.
+               nb_steps: unsigned int for the number of edge swaps per graph
+               prefetch: Maximal number of graphs generated ahead.
+               nb_threads: Number of worker threads.
+               seed: Seed of the workers' RNG (None draws one from the RNG of
+                     the sampler).
+
+            Returns:
+               Iterator of (nb_edges, 2) arrays of (node, group) pairs.
+            )pbdoc", py::arg("nb_graphs"), py::arg("nb_steps") = 0,
+                py::arg("prefetch") = 2, py::arg("nb_threads") = 1,
+                py::arg("seed") = py::none());
+
+    py::class_<GraphPrefetcher>(m, "GraphPrefetcher")
+
+        .def("__iter__", [](py::object self)
+            {
+                return self;
+            })
+
+        .def("__next__", [](GraphPrefetcher& self)
+            {
+                EdgeList edge_list;
+                bool available;
+                {
+                    py::gil_scoped_release release;
+                    available = self.next(edge_list);
+                }
+                if (not available)
+                {
+                    throw py::stop_iteration();
+                }
+                return edge_array(edge_list);
+            })
+
+        .def("__len__", &GraphPrefetcher::size)
+
+        .def("close", &GraphPrefetcher::stop, R"pbdoc(
+            Stop the workers; the iteration ends.
+            )pbdoc", py::call_guard<py::gil_scoped_release>());
+
+    py::class_<HyperedgeList>(m, "HyperedgeList")
+
+        .def(py::init<BipartiteConfigurationModelSampler&>(), R"pbdoc(
+            Nodes of each group of a sampler, updated in O(1) per edge swap
+            and rebuilt after each stub matching. The nodes of group g are
+            nodes[offsets[g]:offsets[g+1]], in no particular order.
+
+            Args:
+               sampler: BCMS object to follow.
+            )pbdoc", py::arg("sampler"), py::keep_alive<1,2>())
+
+        .def_property_readonly("offsets", [](py::object self)
+            {
+                return buffer_array(
+                        self.cast<HyperedgeList&>().get_offsets(), self,
+                        false);
+            }, R"pbdoc(
+            Read-only view on the group offsets, kept up to date.
+            )pbdoc")
+
+        .def_property_readonly("nodes", [](py::object self)
+            {
+                return buffer_array(self.cast<HyperedgeList&>().get_nodes(),
+                        self, false);
+            }, R"pbdoc(
+            Read-only view on the nodes of the groups, kept up to date.
+            )pbdoc");
+
+    py::class_<GroupOverlapTracker>(m, "GroupOverlapTracker")
+
+        .def(py::init<BipartiteConfigurationModelSampler&>(), R"pbdoc(
+            Pairwise group overlaps and node co-memberships of a sampler,
+            rebuilt after each stub matching and updated after each edge
+            swap in O(m + n).
+
+            Args:
+               sampler: BCMS object to follow.
+            )pbdoc", py::arg("sampler"), py::keep_alive<1,2>())
+
+        .def("overlap", &GroupOverlapTracker::get_overlap, R"pbdoc(
+            Returns the number of nodes shared by two groups.
+            )pbdoc", py::arg("group1"), py::arg("group2"))
+
+        .def("co_membership", &GroupOverlapTracker::get_co_membership,
+            R"pbdoc(
+            Returns the number of groups shared by two nodes.
+            )pbdoc", py::arg("node1"), py::arg("node2"))
+
+        .def_property_readonly("overlap_distribution",
+            &GroupOverlapTracker::get_overlap_distribution, R"pbdoc(
+            Number of group pairs sharing k nodes, indexed by k.
+            )pbdoc")
+
+        .def_property_readonly("co_membership_distribution",
+            &GroupOverlapTracker::get_co_membership_distribution, R"pbdoc(
+            Number of node pairs sharing k groups, indexed by k.
+            )pbdoc")
+
+        .def_property_readonly("nb_repeated_pairs",
+            &GroupOverlapTracker::get_nb_repeated_pairs, R"pbdoc(
+            Number of node pairs sharing more than one group.
+            )pbdoc");
+
+    py::class_<ClusteringTracker>(m, "ClusteringTracker")
+
+        .def(py::init<BipartiteConfigurationModelSampler&>(), R"pbdoc(
+            Triangles and clustering of the node projection of a sampler,
+            rebuilt after each stub matching and updated after each edge
+            swap.
+
+            Args:
+               sampler: BCMS object to follow.
+            )pbdoc", py::arg("sampler"), py::keep_alive<1,2>())
+
+        .def_property_readonly("nb_edges", &ClusteringTracker::get_nb_edges,
+            R"pbdoc(
+            Number of edges of the projection.
+            )pbdoc")
+
+        .def_property_readonly("nb_triangles",
+            static_cast<unsigned long long (ClusteringTracker::*)() const>(
+                &ClusteringTracker::get_nb_triangles), R"pbdoc(
+            Number of triangles of the projection.
+            )pbdoc")
+
+        .def_property_readonly("global_clustering",
+            &ClusteringTracker::get_global_clustering, R"pbdoc(
+            Three times the number of triangles over the number of connected
+            triples.
+            )pbdoc")
+
+        .def_property_readonly("average_clustering",
+            &ClusteringTracker::get_average_clustering, R"pbdoc(
+            Local clustering coefficient averaged over all nodes.
+            )pbdoc")
+
+        .def("local_clustering", &ClusteringTracker::get_local_clustering,
+            R"pbdoc(
+            Returns the local clustering coefficient of a node, 0 if its
+            degree is smaller than 2.
+            )pbdoc", py::arg("node"));
+
+    typedef MetropolisHastingsSampler<AssortativityEnergy>
+        AssortativitySampler;
+    py::class_<AssortativitySampler>(m, "AssortativitySampler")
+
+        .def(py::init<BipartiteConfigurationModelSampler&, double>(),
+            R"pbdoc(
+            Metropolis-Hastings layer over the edge swaps of a sampler,
+            sampling graphs with weight exp(beta*S), where S is the sum over
+            edges of the membership of the node times the size of the group.
+            Positive beta favours assortative graphs, negative beta
+            disassortative ones. Proposals are drawn by the sampler, with its
+            frozen edges and classes.
+
+            Args:
+               sampler: BCMS object to drive.
+               beta: Inverse temperature.
+            )pbdoc", py::arg("sampler"), py::arg("beta"),
+            py::keep_alive<1,2>())
+
+        .def("mcmc_step", static_cast<size_t (AssortativitySampler::*)(
+                    size_t)>(&AssortativitySampler::mcmc_step), R"pbdoc(
+            Propose edge swaps and accept them with the Metropolis-Hastings
+            rule.
+
+            Args:
+               nb_steps: Number of proposals.
+
+            Returns:
+               Number of accepted swaps.
+            )pbdoc", py::arg("nb_steps") = 1,
+            py::call_guard<py::gil_scoped_release>())
+
+        .def_property("beta", &AssortativitySampler::get_beta,
+            &AssortativitySampler::set_beta, R"pbdoc(
+            Inverse temperature.
+            )pbdoc")
+
+        .def_property_readonly("energy", [](const AssortativitySampler& self)
+            {
+                return self.get_energy().get_energy();
+            }, R"pbdoc(
+            Minus the sum over edges of membership times group size.
+            )pbdoc")
+
+        .def_property_readonly("assortativity",
+            [](const AssortativitySampler& self)
+            {
+                return self.get_energy().get_assortativity();
+            }, R"pbdoc(
+            Pearson correlation of the membership and the group size over
+            the edges of the current graph.
+            )pbdoc");
+
+    py::class_<ChainSchedule>(m, "ChainSchedule")
+
+        .def_readonly("burn_in_steps", &ChainSchedule::burn_in_steps,
+            R"pbdoc(
+            Swaps after the stub matching before the observables became
+            stationary (all the swaps performed if they did not).
+            )pbdoc")
+
+        .def_readonly("nb_steps", &ChainSchedule::nb_steps, R"pbdoc(
+            Swaps performed by the tuning run.
+            )pbdoc")
+
+        .def_readonly("thinning_steps", &ChainSchedule::thinning_steps,
+            R"pbdoc(
+            Swaps between two effectively independent graphs.
+            )pbdoc")
+
+        .def_readonly("autocorrelation_time",
+            &ChainSchedule::autocorrelation_time, R"pbdoc(
+            Integrated autocorrelation time of the observables, in swaps.
+            )pbdoc")
+
+        .def_readonly("converged", &ChainSchedule::converged, R"pbdoc(
+            False if the budget was exhausted first.
+            )pbdoc");
+
+    py::class_<EnsembleWriter>(m, "EnsembleWriter")
+
+        .def(py::init<string, vector<unsigned int>, vector<unsigned int>,
+                uint64_t, bool>(), R"pbdoc(
+            Open a binary ensemble file for writing. Graphs are appended one
+            at a time; the file is complete once closed.
+
+            Args:
+               path: Output file.
+               membership_sequence: Sequence of membership
+               group_size_sequence: Sequence of group size
+               seed: Seed recorded in the header.
+               compress: Store the graphs sorted by node with delta and
+                         varint encoded groups.
+            )pbdoc", py::arg("path"), py::arg("membership_sequence"),
+                py::arg("group_size_sequence"), py::arg("seed") = 0,
+                py::arg("compress") = true)
+
+        .def("write", [](EnsembleWriter& self,
+                    BipartiteConfigurationModelSampler& sampler)
+            {
+                self.write(sampler.get_graph());
+            }, R"pbdoc(
+            Append the current graph of a sampler.
+
+            Args:
+               sampler: BCMS object.
+            )pbdoc", py::arg("sampler"))
+
+        .def("write_random_graphs", &EnsembleWriter::write_random_graphs,
+                R"pbdoc(
+            Append random graphs drawn with sampler.get_random_graph.
+
+            Args:
+               sampler: BCMS object.
+               nb_graphs: Number of graphs to append.
+               nb_steps: unsigned int for the number of edge swaps per graph
+            )pbdoc", py::arg("sampler"), py::arg("nb_graphs"),
+                py::arg("nb_steps") = 0,
+                py::call_guard<py::gil_scoped_release>())
+
+        .def("close", &EnsembleWriter::close, R"pbdoc(
+            Write the number of graphs in the header and close the file.
+            )pbdoc")
+
+        .def("__len__", &EnsembleWriter::size)
+
+        .def("__enter__", [](EnsembleWriter& self) -> EnsembleWriter&
+            {
+                return self;
+            }, py::return_value_policy::reference)
+
+        .def("__exit__", [](EnsembleWriter& self, py::args)
+            {
+                self.close();
+            });
+
+    py::class_<EnsembleReader>(m, "EnsembleReader")
+
+        .def(py::init<string>(), R"pbdoc(
+            Memory-map a binary ensemble file.
+
+            Args:
+               path: Ensemble file.
+            )pbdoc", py::arg("path"))
+
+        .def("__len__", &EnsembleReader::size)
+
+        .def("__getitem__", [](py::object self, long index)
+            {
+                EnsembleReader& reader = self.cast<EnsembleReader&>();
+                if (index < 0)
+                {
+                    index += reader.size();
+                }
+                if (index < 0 or size_t(index) >= reader.size())
+                {
+                    throw py::index_error("Graph index out of range.");
+                }
+                vector<py::ssize_t> shape = {
+                    py::ssize_t(reader.get_nb_edges()), 2};
+                if (reader.is_compressed())
+                {
+                    py::array_t<uint32_t> edges(shape);
+                    reader.decode(index, edges.mutable_data());
+                    return edges;
+                }
+                //zero-copy view on the mapping, keeping the reader alive
+                py::array_t<uint32_t> edges(shape, reader.raw_graph(index),
+                        self);
+                edges.attr("setflags")(py::arg("write") = false);
+                return edges;
+            }, R"pbdoc(
+            Get a graph as a (nb_edges, 2) array of (node, group) pairs. Raw
+            graphs are read-only views on the file; compressed graphs are
+            decoded (sorted by node then group).
+
+            Args:
+               index: Index of the graph in the file.
+            )pbdoc", py::arg("index"))
+
+        .def_property_readonly("seed", &EnsembleReader::get_seed)
+
+        .def_property_readonly("compressed", &EnsembleReader::is_compressed)
+
+        .def_property_readonly("membership_sequence",
+                &EnsembleReader::get_membership_sequence)
+
+        .def_property_readonly("group_size_sequence",
+                &EnsembleReader::get_group_size_sequence);
+
+    py::class_<SharedEnsembleWriter>(m, "SharedEnsembleWriter")
+
+        .def(py::init<string, vector<unsigned int>, vector<unsigned int>,
+                size_t, uint64_t>(), R"pbdoc(
+            Create a POSIX shared-memory segment holding up to capacity raw
+            graphs, readable from other processes with SharedEnsembleReader
+            while graphs are appended. The segment persists until unlinked.
+
+            Args:
+               name: Name of the segment, e.g. "/horgg".
+               membership_sequence: Sequence of membership
+               group_size_sequence: Sequence of group size
+               capacity: Maximal number of graphs.
+               seed: Seed recorded in the header.
+            )pbdoc", py::arg("name"), py::arg("membership_sequence"),
+                py::arg("group_size_sequence"), py::arg("capacity"),
+                py::arg("seed") = 0)
+
+        .def("write", [](SharedEnsembleWriter& self,
+                    BipartiteConfigurationModelSampler& sampler)
+            {
+                self.write(sampler.get_graph());
+            }, R"pbdoc(
+            Append the current graph of a sampler.
+
+            Args:
+               sampler: BCMS object.
+            )pbdoc", py::arg("sampler"))
+
+        .def("write_random_graphs",
+                &SharedEnsembleWriter::write_random_graphs, R"pbdoc(
+            Append random graphs drawn with sampler.get_random_graph.
+
+            Args:
+               sampler: BCMS object.
+               nb_graphs: Number of graphs to append.
+               nb_steps: unsigned int for the number of edge swaps per graph
+            )pbdoc", py::arg("sampler"), py::arg("nb_graphs"),
+                py::arg("nb_steps") = 0,
+                py::call_guard<py::gil_scoped_release>())
+
+        .def("close", &SharedEnsembleWriter::close, R"pbdoc(
+            Unmap the segment; the graphs remain available to the readers.
+            )pbdoc")
+
+        .def_static("unlink", &SharedEnsembleWriter::unlink, R"pbdoc(
+            Remove a segment; its memory is freed once no process maps it.
+
+            Args:
+               name: Name of the segment.
+            )pbdoc", py::arg("name"))
+
+        .def_property_readonly("capacity",
+                &SharedEnsembleWriter::get_capacity)
+
+        .def("__len__", &SharedEnsembleWriter::size)
+
+        .def("__enter__", [](SharedEnsembleWriter& self)
+                -> SharedEnsembleWriter&
+            {
+                return self;
+            }, py::return_value_policy::reference)
+
+        .def("__exit__", [](SharedEnsembleWriter& self, py::args)
+            {
+                self.close();
+            });
+
+    py::class_<SharedEnsembleReader>(m, "SharedEnsembleReader")
+
+        .def(py::init<string>(), R"pbdoc(
+            Attach to a shared-memory segment created by SharedEnsembleWriter,
+            possibly in another process.
+
+            Args:
+               name: Name of the segment.
+            )pbdoc", py::arg("name"))
+
+        .def("__len__", &SharedEnsembleReader::size, R"pbdoc(
+            Number of graphs written so far.
+            )pbdoc")
+
+        .def("__getitem__", [](py::object self, long index)
+            {
+                SharedEnsembleReader& reader =
+                    self.cast<SharedEnsembleReader&>();
+                if (index < 0)
+                {
+                    index += reader.size();
+                }
+                if (index < 0 or size_t(index) >= reader.size())
+                {
+                    throw py::index_error("Graph index out of range.");
+                }
+                //zero-copy view on the segment, keeping the reader alive
+                py::array_t<uint32_t> edges({
+                        py::ssize_t(reader.get_nb_edges()), py::ssize_t(2)},
+                        reader.raw_graph(index), self);
+                edges.attr("setflags")(py::arg("write") = false);
+                return edges;
+            }, R"pbdoc(
+            Get a graph as a read-only (nb_edges, 2) view of (node, group)
+            pairs on the segment.
+
+            Args:
+               index: Index of the graph.
+            )pbdoc", py::arg("index"))
+
+        .def("wait", [](const SharedEnsembleReader& self, size_t nb_graphs,
+                    double timeout)
+            {
+                return self.wait(nb_graphs,
+                        chrono::duration_cast<Clock::duration>(
+                            chrono::duration<double>(timeout)));
+            }, R"pbdoc(
+            Wait until at least nb_graphs graphs are written or the timeout
+            expires.
+
+            Args:
+               nb_graphs: Number of graphs to wait for.
+               timeout: Timeout in seconds.
+
+            Returns:
+               Number of graphs available.
+            )pbdoc", py::arg("nb_graphs"), py::arg("timeout"),
+                py::call_guard<py::gil_scoped_release>())
+
+        .def_property_readonly("capacity",
+                &SharedEnsembleReader::get_capacity)
+
+        .def_property_readonly("seed", &SharedEnsembleReader::get_seed)
+
+        .def_property_readonly("nb_nodes", &SharedEnsembleReader::get_nb_nodes)
+
+        .def_property_readonly("nb_groups",
+                &SharedEnsembleReader::get_nb_groups);
+
+    py::class_<SwapLog>(m, "SwapLog")
+
+        .def(py::init<size_t>(), R"pbdoc(
+            Compact record of a thinned chain: the first graph is stored in
+            full and the later snapshots as the swaps applied since the
+            previous one.
+
+            Args:
+               keyframe_interval: Store a full copy every keyframe_interval
+                                  snapshots to speed up random access
+                                  (0 for none).
+            )pbdoc", py::arg("keyframe_interval") = 0)
+
+        .def("record", &SwapLog::record, R"pbdoc(
+            Record snapshots of the chain of a sampler, starting with its
+            current graph. Any previous record is discarded.
+
+            Args:
+               sampler: BCMS object.
+               nb_snapshots: Number of snapshots.
+               nb_steps: unsigned int for the number of edge swaps between
+                         snapshots
+            )pbdoc", py::arg("sampler"), py::arg("nb_snapshots"),
+                py::arg("nb_steps"), py::call_guard<py::gil_scoped_release>())
+
+        .def("__len__", &SwapLog::size)
+
+        .def("__getitem__", [](const SwapLog& self, long index)
+            {
+                if (index < 0)
+                {
+                    index += self.size();
+                }
+                if (index < 0 or size_t(index) >= self.size())
+                {
+                    throw py::index_error("Snapshot index out of range.");
+                }
+                return edge_array(self.get_graph(index));
+            }, R"pbdoc(
+            Materialise a snapshot as a (nb_edges, 2) array of (node, group)
+            pairs.
+
+            Args:
+               index: Index of the snapshot.
+            )pbdoc", py::arg("index"))
+
+        .def_property_readonly("nb_swaps", &SwapLog::get_nb_swaps)
+
+        .def("save", &SwapLog::save, R"pbdoc(
+            Write the log to a binary file.
+
+            Args:
+               path: Output file.
+            )pbdoc", py::arg("path"))
+
+        .def_static("load", &SwapLog::load, R"pbdoc(
+            Read a log written with save.
+
+            Args:
+               path: Log file.
+               keyframe_interval: Keyframe interval of the loaded log.
+            )pbdoc", py::arg("path"), py::arg("keyframe_interval") = 0);
+
+    m.def("_sequence_1", [](size_t size, vector<double> dist, uint64_t seed)
+        {
+            SequenceArray sequence(size);
+            unsigned int* data = sequence.mutable_data();
+            {
+                py::gil_scoped_release release;
+                RNGType gen(seed);
+                sequence_1(data, size, dist, gen);
+            }
+            return sequence;
+        }, R"pbdoc(
+        Sequence of values distributed according to dist, drawn with an alias
+        table. Use horgg.utility.sequence_1 instead.
+        )pbdoc", py::arg("N"), py::arg("dist"), py::arg("seed"));
+
+    m.def("_sequence_2", [](SequenceArray seq_1, vector<double> dist,
+                uint64_t seed)
+        {
+            vector<unsigned int> sequence(seq_1.data(),
+                    seq_1.data()+seq_1.size());
+            {
+                py::gil_scoped_release release;
+                RNGType gen(seed);
+                sequence = sequence_2(sequence, dist, gen);
+            }
+            return vector_array(move(sequence));
+        }, R"pbdoc(
+        Sequence of values distributed according to dist whose sum is the
+        sum of seq_1. Use horgg.utility.sequence_2 instead.
+        )pbdoc", py::arg("seq_1"), py::arg("dist"), py::arg("seed"));
+
+    m.def("_sequence_2_exact", [](SequenceArray seq_1, vector<double> dist,
+                uint64_t seed, bool ensure_bigraphic, unsigned int max_attempts)
+        {
+            vector<unsigned int> sequence(seq_1.data(),
+                    seq_1.data()+seq_1.size());
+            {
+                py::gil_scoped_release release;
+                RNGType gen(seed);
+                sequence = sequence_2_exact(sequence, dist, gen,
+                        ensure_bigraphic, max_attempts);
+            }
+            return vector_array(move(sequence));
+        }, R"pbdoc(
+        Sequence of values distributed according to dist, conditioned on
+        summing exactly to the sum of seq_1. Use
+        horgg.utility.sequence_2_exact instead.
+        )pbdoc", py::arg("seq_1"), py::arg("dist"), py::arg("seed"),
+            py::arg("ensure_bigraphic"), py::arg("max_attempts"));
+
+    m.def("get_joint_degree_matrix", &get_joint_degree_matrix, R"pbdoc(
+        Number of edges between nodes of membership m and groups of size s.
+
+        Args:
+           edge_list: List of (node, group) edges.
+
+        Returns:
+           dict mapping (m, s) to the number of edges.
+        )pbdoc", py::arg("edge_list"));
+
+    m.def("joint_degree_graph", &joint_degree_graph, R"pbdoc(
+        Simple graph with the given joint degree matrix, with nodes labeled
+        by increasing membership and groups by increasing size. Use it as
+        the initial graph of a BCMS with preserve_joint_degrees() to sample
+        graphs with this joint degree matrix.
+
+        Args:
+           matrix: dict mapping (m, s) to the number of edges between nodes
+                   of membership m and groups of size s.
+
+        Returns:
+           List of (node, group) edges.
+        )pbdoc", py::arg("matrix"), py::call_guard<py::gil_scoped_release>());
+
+    m.def("tune_chain", &tune_chain, R"pbdoc(
+        Start a new chain from a stub matching, discarding the current graph
+        of the sampler, and perform edge swaps until two sums over the edges
+        (membership times group size, and products of fixed random signs of
+        the nodes and groups) look stationary, from their integrated
+        autocorrelation time. Both are updated in O(1) per swap. The sampler
+        is left at the last state; further graphs are obtained with
+        mcmc_step(thinning_steps) followed by get_graph().
+
+        Args:
+           sampler: BCMS object.
+           max_steps: Maximal number of edge swaps.
+           interval: Swaps between two records of the observables (0 for
+                     a tenth of the number of edges).
+
+        Returns:
+           ChainSchedule with the burn-in and thinning in edge swaps.
+        )pbdoc", py::arg("sampler"), py::arg("max_steps"),
+        py::arg("interval") = 0, py::call_guard<py::gil_scoped_release>());
+
+    m.def("sample_graph", [](vector<double> group_size_dist,
+                vector<double> membership_dist, size_t nb_groups,
+                unsigned long long seed, unsigned int nb_steps, bool exact_sum,
+                unsigned int max_attempts)
+        {
+            PipelineParameters parameters{group_size_dist, membership_dist,
+                nb_groups, seed, nb_steps, exact_sum, max_attempts};
+            EdgeList edge_list;
+            {
+                py::gil_scoped_release release;
+                edge_list = sample_graph(parameters);
+            }
+            return edge_array(edge_list);
+        }, R"pbdoc(
+        Draw the group sizes and memberships from their distributions, then
+        sample a graph, in a single call.
+
+        Args:
+           group_size_dist: array for the distribution of group sizes
+           membership_dist: array for the distribution of memberships
+           nb_groups: Number of groups.
+           seed: Seed of the RNG.
+           nb_steps: unsigned int for the number of edge swaps to perform
+           exact_sum: Use sequence_2_exact for the memberships.
+           max_attempts: Maximal number of draws of the sequences when their
+                         sums cannot be matched or they are not bigraphic.
+
+        Returns:
+           (nb_edges, 2) array of (node, group) pairs.
+
+        Raises:
+           RuntimeError: if no graph was sampled in max_attempts draws.
+        )pbdoc", py::arg("group_size_dist"), py::arg("membership_dist"),
+            py::arg("nb_groups"), py::arg("seed"), py::arg("nb_steps") = 0,
+            py::arg("exact_sum") = false, py::arg("max_attempts") = 100);
+
+    m.def("sample_graphs", [](vector<double> group_size_dist,
+                vector<double> membership_dist, size_t nb_groups,
+                unsigned long long seed, size_t nb_graphs,
+                unsigned int nb_steps, bool exact_sum, unsigned int nb_threads,
+                unsigned int max_attempts)
+        {
+            PipelineParameters parameters{group_size_dist, membership_dist,
+                nb_groups, seed, nb_steps, exact_sum, max_attempts};
+            vector<EdgeList> graphs;
+            {
+                py::gil_scoped_release release;
+                graphs = sample_graphs(parameters, nb_graphs, nb_threads);
+            }
+            py::list arrays;
+            for (auto& edge_list : graphs)
+            {
+                arrays.append(edge_array(edge_list));
+            }
+            return arrays;
+        }, R"pbdoc(
+        Batched version of sample_graph, with the graphs sampled in parallel.
+        The graphs only depend on the seed, not on the number of threads.
+
+        Args:
+           group_size_dist: array for the distribution of group sizes
+           membership_dist: array for the distribution of memberships
+           nb_groups: Number of groups.
+           seed: Seed of the RNG.
+           nb_graphs: Number of graphs.
+           nb_steps: unsigned int for the number of edge swaps to perform
+           exact_sum: Use sequence_2_exact for the memberships.
+           nb_threads: Number of threads (0 for the hardware concurrency).
+           max_attempts: Maximal number of draws of the sequences of each
+                         graph when their sums cannot be matched or they are
+                         not bigraphic.
+
+        Returns:
+           List of (nb_edges, 2) arrays of (node, group) pairs.
+
+        Raises:
+           RuntimeError: if a graph was not sampled in max_attempts draws.
+        )pbdoc", py::arg("group_size_dist"), py::arg("membership_dist"),
+            py::arg("nb_groups"), py::arg("seed"), py::arg("nb_graphs"),
+            py::arg("nb_steps") = 0, py::arg("exact_sum") = false,
+            py::arg("nb_threads") = 0, py::arg("max_attempts") = 100);
+
+    py::module::import("atexit").attr("register")(
+            py::cpp_function(&cancel_pending_tasks));
+
+    py::class_<CancellationToken>(m, "CancellationToken")
+
+        .def("cancel", &CancellationToken::cancel, R"pbdoc(
+            Stop the task at its next check.
+            )pbdoc");
+
+    m.def("_submit_random_graph", [](BipartiteConfigurationModelSampler&
+                sampler, unsigned int nb_steps, py::object seed,
+                unsigned long long stream, py::function callback)
+        {
+            //the worker draws from a copy, with the frozen edges and the
+            //classes of sampler
+            auto copy = make_shared<BipartiteConfigurationModelSampler>(
+                    sampler);
+            unsigned long long seed_value = seed.is_none() ?
+                sampler.draw_seed() : seed.cast<unsigned long long>();
+            CancellationToken token{make_shared<atomic<bool> >(false)};
+            //the callback is only touched with the GIL held
+            auto done = make_shared<py::object>(move(callback));
+            shared_ptr<atomic<bool> > cancelled = token.cancelled;
+            {
+                lock_guard<mutex> guard(pending_tasks().lock);
+                pending_tasks().flags.insert(cancelled);
+            }
+            async_pool().submit([=]()
+                {
+                    EdgeList edge_list;
+                    bool completed = false;
+                    string error_type;
+                    string error_message;
+                    try
+                    {
+                        completed = sample_graph(*copy, nb_steps,
+                                seed_value, stream, *cancelled, edge_list);
+                    }
+                    catch (invalid_argument& e)
+                    {
+                        error_type = "ValueError";
+                        error_message = e.what();
+                    }
+                    catch (exception& e)
+                    {
+                        error_type = "RuntimeError";
+                        error_message = e.what();
+                    }
+                    {
+                        lock_guard<mutex> guard(pending_tasks().lock);
+                        pending_tasks().flags.erase(cancelled);
+                    }
+                    if (python_is_finalizing())
+                    {
+                        //taking the GIL would hang the thread; the callback
+                        //is leaked since nobody waits for the result
+                        done->release();
+                        return;
+                    }
+                    py::gil_scoped_acquire acquire;
+                    try
+                    {
+                        if (not error_type.empty())
+                        {
+                            (*done)(py::none(), py::module::import("builtins")
+                                .attr(error_type.c_str())(error_message));
+                        }
+                        else if (completed)
+                        {
+                            (*done)(edge_array(edge_list), py::none());
+                        }
+                        else
+                        {
+                            (*done)(py::none(), py::module::import("asyncio")
+                                .attr("CancelledError")());
+                        }
+                    }
+                    catch (py::error_already_set&)
+                    {
+                        //the event loop is gone, nobody waits for the result
+                    }
+                    done->release().dec_ref();
+                });
+            return token;
+        }, R"pbdoc(
+        Sample a graph from a copy of sampler on the asyncio thread pool
+        and call callback(edges, error) from the worker thread when done. Use
+        horgg.aio instead.
+        )pbdoc", py::arg("sampler"), py::arg("nb_steps"), py::arg("seed"),
+            py::arg("stream"), py::arg("callback"));
+
+    m.def("enable_tracing", &trace::enable, R"pbdoc(
+        Start recording phase spans (stub matching, repair, mcmc, ...). Tracing
+        is also enabled at import when the HORGG_TRACE environment variable is
+        set to a non-zero value.
+        )pbdoc");
+
+    m.def("disable_tracing", &trace::disable, R"pbdoc(
+        Stop recording phase spans.
+        )pbdoc");
+
+    m.def("clear_trace", &trace::clear, R"pbdoc(
+        Drop all the recorded spans.
+        )pbdoc");
+
+    m.def("dump_chrome_trace", &trace::dump_chrome_trace, R"pbdoc(
+        Write the recorded spans in the Chrome trace event JSON format.
+
+        Args:
+           path: Output file, to be opened with chrome://tracing or Perfetto.
+        )pbdoc", py::arg("path"));
+
+    m.def("dump_span_log", &trace::dump_span_log, R"pbdoc(
+        Write the recorded spans as plain text, one "tid start duration name"
+        line per span, with times in nanoseconds since the trace epoch.
+
+        Args:
+           path: Output file.
+        )pbdoc", py::arg("path"));
 }
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Unit tests for the asyncio front end
+
+Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
+"""
+
+import asyncio
+import pytest
+from horgg import BCMS
+from horgg import aio
+
+
+class TestAsyncio:
+    """Tests for the awaitable sampling"""
+
+    def test_get_random_graph(self):
+        m_list = [3]*100
+        n_list = [5]*60
+        sampler = BCMS(m_list, n_list)
+        edges = asyncio.run(aio.get_random_graph(sampler, 100, seed=42))
+        assert edges.shape == (300, 2)
+        again = asyncio.run(aio.get_random_graph(sampler, 100, seed=42))
+        assert (edges == again).all()
+
+    def test_concurrent_graphs(self):
+        m_list = [3]*100
+        n_list = [5]*60
+        sampler = BCMS(m_list, n_list)
+        graphs = asyncio.run(aio.get_random_graphs(sampler, 8, 100, seed=1))
+        assert len(graphs) == 8
+        assert not (graphs[0] == graphs[1]).all()
+
+    def test_frozen_edges(self):
+        BCMS.seed(42)
+        edge_list = BCMS([3]*100, [5]*60).get_graph()
+        frozen = [i % 3 == 0 for i in range(len(edge_list))]
+        sampler = BCMS(edge_list, frozen)
+        edges = asyncio.run(aio.get_random_graph(sampler, 100, seed=42))
+        assert all(tuple(edges[i]) == edge_list[i]
+                   for i in range(len(edge_list)) if frozen[i])
+        assert sampler.get_graph() == edge_list
+
+    def test_cancellation(self):
+        m_list = [3]*100
+        n_list = [5]*60
+        sampler = BCMS(m_list, n_list)
+
+        async def cancel():
+            task = asyncio.ensure_future(
+                aio.get_random_graph(sampler, 2**31))
+            await asyncio.sleep(0.01)
+            task.cancel()
+            with pytest.raises(asyncio.CancelledError):
+                await task
+
+        asyncio.run(asyncio.wait_for(cancel(), timeout=10))
@@ -6,9 +6,10 @@ Unit tests
 Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
 """
 
+import time
 import pytest
 import numpy as np
-from horgg import BCMS
+from horgg import BCMS, get_joint_degree_matrix, joint_degree_graph
 
 class TestOutput:
     """Tests for the properties of the generated bipartite graphs"""
@@ -75,3 +76,162 @@ class TestBigraphicSeq:
         m_list = [4,4,2]
         n_list = [2,2,2,2,2]
         graph_generator = BCMS(m_list,n_list)
+
+
+class TestTimeBudget:
+    """Tests for the time-budgeted sampling"""
+    def test_budget(self):
+        m_list = [3]*1000
+        n_list = [5]*600
+        graph_generator = BCMS(m_list,n_list)
+        start = time.perf_counter()
+        edge_list, nb_steps = graph_generator.get_random_graph_within(0.05)
+        assert time.perf_counter() - start < 1.
+        assert nb_steps > 0
+        assert len(set(edge_list)) == len(edge_list) == 3000
+
+    def test_stub_matching_too_slow(self):
+        m_list = [3]*100000
+        n_list = [5]*60000
+        graph_generator = BCMS(m_list,n_list)
+        with pytest.raises(RuntimeError):
+            graph_generator.get_random_graph_within(1e-6)
+
+    def test_valid_after_timeout(self):
+        m_list = [3]*100000
+        n_list = [5]*60000
+        graph_generator = BCMS(m_list,n_list)
+        edge_list = graph_generator.get_graph()
+        with pytest.raises(RuntimeError):
+            graph_generator.get_random_graph_within(1e-4)
+        assert graph_generator.get_graph() == edge_list
+        graph_generator.mcmc_step(10000)
+        edge_list = graph_generator.get_graph()
+        assert len(set(edge_list)) == len(edge_list) == 300000
+
+
+class TestPrefetch:
+    """Tests for the background generation of graphs"""
+    def test_iter_random_graphs(self):
+        m_list = [3]*100
+        n_list = [5]*60
+        graph_generator = BCMS(m_list,n_list)
+        graphs = [graph for graph in graph_generator.iter_random_graphs(
+            10, nb_steps=100, prefetch=3, seed=42)]
+        assert len(graphs) == 10
+        for graph in graphs:
+            assert graph.shape == (300, 2)
+            assert len(set(map(tuple, graph))) == 300
+        again = list(graph_generator.iter_random_graphs(
+            10, nb_steps=100, prefetch=1, seed=42))
+        assert all((a == b).all() for a, b in zip(graphs, again))
+
+    def test_close(self):
+        m_list = [3]*100
+        n_list = [5]*60
+        graph_generator = BCMS(m_list,n_list)
+        prefetch = 2
+        nb_threads = 2
+        iterator = graph_generator.iter_random_graphs(
+            1000, nb_steps=20000, prefetch=prefetch, nb_threads=nb_threads)
+        next(iterator)
+        start = time.perf_counter()
+        iterator.close()
+        assert time.perf_counter() - start < 1.
+        #only the graphs generated ahead are left
+        assert len(list(iterator)) <= prefetch + nb_threads
+
+    def test_close_during_generation(self):
+        graph_generator = BCMS([3]*100, [5]*60)
+        iterator = graph_generator.iter_random_graphs(10, nb_steps=10**9)
+        time.sleep(0.05)
+        start = time.perf_counter()
+        iterator.close()
+        assert time.perf_counter() - start < 1.
+        assert len(list(iterator)) == 0
+
+
+class TestFrozenEdges:
+    """Tests for the partial randomisation with frozen edges"""
+
+    def test_frozen_edges_are_kept(self):
+        BCMS.seed(42)
+        edge_list = BCMS([3]*50, [5]*30).get_graph()
+        frozen = [i % 3 == 0 for i in range(len(edge_list))]
+        sampler = BCMS(edge_list, frozen)
+        sampler.mcmc_step(2000)
+        graph = sampler.get_graph()
+        for edge, new_edge, keep in zip(edge_list, graph, frozen):
+            assert new_edge[0] == edge[0]
+            if keep:
+                assert new_edge == edge
+        assert graph != edge_list
+        graph = sampler.get_random_graph(10)
+        assert len(set(graph)) == len(graph)
+        assert all(new_edge == edge for edge, new_edge, keep
+                   in zip(edge_list, graph, frozen) if keep)
+
+
+class TestClasses:
+    """Tests for the swaps restricted to node and group classes"""
+
+    def composition(self, graph, node_classes, group_classes):
+        counts = dict()
+        for node, group in graph:
+            key = (node, group_classes[group])
+            counts[key] = counts.get(key, 0) + 1
+            key = (group, node_classes[node], None)
+            counts[key] = counts.get(key, 0) + 1
+        return counts
+
+    def test_classes_are_preserved(self):
+        BCMS.seed(42)
+        sampler = BCMS([3]*50, [5]*30)
+        node_classes = [i % 2 for i in range(50)]
+        group_classes = [i % 3 for i in range(30)]
+        sampler.set_classes(node_classes, group_classes)
+        edge_list = sampler.get_graph()
+        expected = self.composition(edge_list, node_classes, group_classes)
+        sampler.mcmc_step(2000)
+        graph = sampler.get_graph()
+        assert graph != edge_list
+        assert self.composition(graph, node_classes, group_classes) \
+            == expected
+        graph = sampler.get_random_graph(10)
+        assert len(set(graph)) == len(graph)
+        assert self.composition(graph, node_classes, group_classes) \
+            == expected
+
+    def test_invalid_classes(self):
+        sampler = BCMS([3]*50, [5]*30)
+        with pytest.raises(ValueError):
+            sampler.set_classes([0]*49, [])
+
+
+class TestJointDegree:
+    """Tests for the joint-degree-preserving swaps"""
+    def test_initial_graph(self):
+        m_list = [1]*40 + [2]*30 + [4]*10
+        n_list = [2]*30 + [5]*16
+        matrix = get_joint_degree_matrix(BCMS(m_list,n_list).get_graph())
+        edge_list = joint_degree_graph(matrix)
+        assert len(set(edge_list)) == len(edge_list) == 140
+        assert get_joint_degree_matrix(edge_list) == matrix
+
+    def test_swaps_preserve_matrix(self):
+        matrix = {(1,2): 20, (1,5): 20, (2,2): 40, (3,5): 30}
+        edge_list = joint_degree_graph(matrix)
+        graph_generator = BCMS(edge_list)
+        graph_generator.preserve_joint_degrees(by_group_size=True)
+        graph_generator.mcmc_step(5000)
+        graph = graph_generator.get_graph()
+        assert graph != edge_list
+        assert get_joint_degree_matrix(graph) == matrix
+        graph = graph_generator.get_random_graph(10)
+        assert get_joint_degree_matrix(graph) == matrix
+
+    def test_not_graphic(self):
+        with pytest.raises(ValueError):
+            joint_degree_graph({(2,3): 5})
+        with pytest.raises(ValueError):
+            joint_degree_graph({(2,2): 2})
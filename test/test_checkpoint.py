@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Unit tests for the checkpoints of the sampler state
+
+Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
+"""
+
+import pickle
+import pytest
+from horgg import BCMS
+
+
+class TestCheckpoint:
+    """Tests that restored chains continue identically"""
+
+    def continue_chain(self, sampler):
+        sampler.mcmc_step(1000)
+        first = sampler.get_graph()
+        second = sampler.get_random_graph(100)
+        return first, second
+
+    def test_shared_rng(self, tmp_path):
+        BCMS.seed(42)
+        sampler = BCMS([3]*50, [5]*30)
+        sampler.get_random_graph(100)
+        path = str(tmp_path / "sampler.state")
+        sampler.save_state(path)
+        expected = self.continue_chain(sampler)
+        restored = BCMS.load_state(path)
+        assert self.continue_chain(restored) == expected
+
+    def test_local_rng(self):
+        sampler = BCMS([3]*50, [5]*30, seed=7)
+        sampler.get_random_graph(100)
+        state = pickle.dumps(sampler)
+        expected = self.continue_chain(sampler)
+        restored = pickle.loads(state)
+        assert restored.get_membership_sequence() == [3]*50
+        assert self.continue_chain(restored) == expected
+
+    def test_shared_rng_untouched(self, tmp_path):
+        BCMS.seed(42)
+        sampler = BCMS([3]*50, [5]*30)
+        path = str(tmp_path / "sampler.state")
+        sampler.save_state(path)
+        BCMS.seed(7)
+        expected = BCMS([3]*50, [5]*30).get_random_graph(100)
+        BCMS.seed(7)
+        BCMS.load_state(path)
+        pickle.loads(pickle.dumps(sampler))
+        assert BCMS([3]*50, [5]*30).get_random_graph(100) == expected
+
+    def test_frozen_edges(self):
+        BCMS.seed(42)
+        edge_list = BCMS([3]*50, [5]*30).get_graph()
+        frozen = [i % 2 == 0 for i in range(len(edge_list))]
+        sampler = BCMS(edge_list, frozen)
+        restored = pickle.loads(pickle.dumps(sampler, protocol=5))
+        assert list(restored.frozen_edges) == frozen
+
+    def test_classes(self):
+        sampler = BCMS([3]*50, [5]*30)
+        node_classes = [i % 2 for i in range(50)]
+        group_classes = [i % 3 for i in range(30)]
+        sampler.set_classes(node_classes, group_classes)
+        restored = pickle.loads(pickle.dumps(sampler, protocol=5))
+        assert list(restored.node_classes) == node_classes
+        assert list(restored.group_classes) == group_classes
+
+    @pytest.mark.parametrize("version", [2, 3])
+    def test_older_version(self, tmp_path, version):
+        BCMS.seed(42)
+        sampler = BCMS([3]*50, [5]*30)
+        path = tmp_path / "sampler.state"
+        sampler.save_state(str(path))
+        #drop the empty arrays added by later versions (frozen edges, then
+        #node and group classes) and write the older version number
+        data = bytearray(path.read_bytes())
+        nb_arrays = 3 if version == 2 else 2
+        assert data[-8*nb_arrays:] == bytes(8*nb_arrays)
+        del data[-8*nb_arrays:]
+        data[16:20] = version.to_bytes(4, "little")
+        path.write_bytes(bytes(data))
+        restored = BCMS.load_state(str(path))
+        assert restored.get_graph() == sampler.get_graph()
+        assert len(restored.frozen_edges) == 0
+        assert len(restored.node_classes) == 0
+        expected = sampler.get_random_graph(100)
+        assert restored.get_random_graph(100) == expected
+
+    def test_invalid_state(self, tmp_path):
+        path = tmp_path / "sampler.state"
+        path.write_bytes(b"not a sampler state")
+        with pytest.raises(RuntimeError):
+            BCMS.load_state(str(path))
+
+
+class TestPickleProtocol5:
+    """Tests for the out-of-band pickling of samplers"""
+
+    def test_out_of_band(self):
+        sampler = BCMS([3]*50, [5]*30, seed=3)
+        sampler.get_random_graph(100)
+        buffers = []
+        data = pickle.dumps(sampler, protocol=5,
+                            buffer_callback=buffers.append)
+        assert len(buffers) == 6
+        assert len(data) < 200
+        restored = pickle.loads(data, buffers=buffers)
+        assert restored.get_graph() == sampler.get_graph()
+        sampler.mcmc_step(500)
+        restored.mcmc_step(500)
+        assert restored.get_graph() == sampler.get_graph()
+
+    def test_in_band(self):
+        sampler = BCMS([3]*50, [5]*30, seed=3)
+        restored = pickle.loads(pickle.dumps(sampler, protocol=5))
+        assert restored.get_graph() == sampler.get_graph()
+
+    def test_shared_rng_untouched(self):
+        BCMS.seed(42)
+        sampler = BCMS([3]*50, [5]*30)
+        buffers = []
+        data = pickle.dumps(sampler, protocol=5,
+                            buffer_callback=buffers.append)
+        BCMS.seed(7)
+        expected = BCMS([3]*50, [5]*30).get_random_graph(100)
+        BCMS.seed(7)
+        restored = pickle.loads(data, buffers=buffers)
+        assert BCMS([3]*50, [5]*30).get_random_graph(100) == expected
+        assert restored.get_graph() == sampler.get_graph()
+
+    def test_older_version(self):
+        #states of version 2 end after the stub vectors
+        sampler = BCMS([3]*50, [5]*30, seed=7)
+        function, arguments, state = sampler.__reduce_ex__(5)
+        restored = function(*arguments)
+        restored.__setstate__(state[:4])
+        assert restored.get_graph() == sampler.get_graph()
+        assert len(restored.frozen_edges) == 0
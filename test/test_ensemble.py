@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Unit tests for the binary ensemble files
+
+Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
+"""
+
+import pytest
+import numpy as np
+import multiprocessing
+import os
+from horgg import BCMS, EnsembleWriter, EnsembleReader, SwapLog
+from horgg import SharedEnsembleWriter, SharedEnsembleReader
+
+
+class TestEnsembleFile:
+    """Tests for the round trip through an ensemble file"""
+
+    @pytest.mark.parametrize("compress", [True, False])
+    def test_round_trip(self, tmp_path, compress):
+        m_list = [2]*10
+        n_list = [4]*5
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        path = str(tmp_path / "ensemble.horgg")
+        graphs = []
+        with EnsembleWriter(path, m_list, n_list, 42, compress) as writer:
+            for _ in range(3):
+                graphs.append(sorted(sampler.get_random_graph(10)))
+                writer.write(sampler)
+        reader = EnsembleReader(path)
+        assert len(reader) == 3
+        assert reader.seed == 42
+        assert reader.membership_sequence == m_list
+        for index, graph in enumerate(graphs):
+            edges = sorted(map(tuple, reader[index].tolist()))
+            assert edges == graph
+
+    def test_raw_view_is_read_only(self, tmp_path):
+        m_list = [2]*10
+        n_list = [4]*5
+        sampler = BCMS(m_list, n_list)
+        path = str(tmp_path / "ensemble.horgg")
+        with EnsembleWriter(path, m_list, n_list, compress=False) as writer:
+            writer.write_random_graphs(sampler, 2)
+        edges = EnsembleReader(path)[-1]
+        assert edges.shape == (20, 2)
+        with pytest.raises(ValueError):
+            edges[0, 0] = 1
+
+    @pytest.mark.parametrize("compress", [True, False])
+    def test_corrupted_header(self, tmp_path, compress):
+        m_list = [2]*10
+        n_list = [4]*5
+        sampler = BCMS(m_list, n_list)
+        path = tmp_path / "ensemble.horgg"
+        with EnsembleWriter(str(path), m_list, n_list, 0, compress) as writer:
+            writer.write_random_graphs(sampler, 2)
+        data = bytearray(path.read_bytes())
+        #number of edges, whose size in bytes overflows
+        data[40:48] = (2**62).to_bytes(8, "little")
+        path.write_bytes(bytes(data))
+        with pytest.raises(RuntimeError):
+            EnsembleReader(str(path))
+
+    def test_trailing_bytes(self, tmp_path):
+        m_list = [2]*10
+        n_list = [4]*5
+        sampler = BCMS(m_list, n_list)
+        path = tmp_path / "ensemble.horgg"
+        with EnsembleWriter(str(path), m_list, n_list, 0, True) as writer:
+            writer.write_random_graphs(sampler, 1)
+        data = bytearray(path.read_bytes())
+        #first block after the header and the sequences, padded to 8 bytes
+        offset = (56 + 4*(len(m_list) + len(n_list)) + 7)//8*8
+        payload_size = int.from_bytes(data[offset:offset+8], "little")
+        data[offset:offset+8] = (payload_size + 1).to_bytes(8, "little")
+        if payload_size % 8 == 0:
+            data += bytes(8)
+        path.write_bytes(bytes(data))
+        with pytest.raises(RuntimeError):
+            EnsembleReader(str(path))[0]
+
+    def test_sequences_must_match(self, tmp_path):
+        with pytest.raises(ValueError):
+            EnsembleWriter(str(tmp_path / "ensemble.horgg"), [2]*10, [4]*4)
+
+
+class TestSwapLog:
+    """Tests for the delta-encoded chain snapshots"""
+
+    @pytest.mark.parametrize("keyframe_interval", [0, 3])
+    def test_snapshots_match_chain(self, tmp_path, keyframe_interval):
+        m_list = [2]*10
+        n_list = [4]*5
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        expected = [sorted(sampler.get_graph())]
+        for _ in range(9):
+            for _ in range(5):
+                sampler.mcmc_step()
+            expected.append(sorted(sampler.get_graph()))
+
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        log = SwapLog(keyframe_interval)
+        log.record(sampler, 10, 5)
+        assert len(log) == 10
+        path = str(tmp_path / "chain.log")
+        log.save(path)
+        for stored in [log, SwapLog.load(path)]:
+            for index, graph in enumerate(expected):
+                assert sorted(map(tuple, stored[index].tolist())) == graph
+
+    def test_corrupted_size(self, tmp_path):
+        sampler = BCMS([2]*10, [4]*5)
+        log = SwapLog()
+        log.record(sampler, 3, 5)
+        path = tmp_path / "chain.log"
+        log.save(str(path))
+        data = bytearray(path.read_bytes())
+        #size of the base edge list, after the magic and the version
+        data[12:20] = (2**60).to_bytes(8, "little")
+        path.write_bytes(bytes(data))
+        with pytest.raises(RuntimeError):
+            SwapLog.load(str(path))
+        path.write_bytes(path.read_bytes()[:20])
+        with pytest.raises(RuntimeError):
+            SwapLog.load(str(path))
+
+
+def read_shared_ensemble(name, nb_graphs):
+    """read_shared_ensemble returns the first nb_graphs graphs of a shared
+    ensemble as lists of (node, group) pairs, from another process."""
+    reader = SharedEnsembleReader(name)
+    assert reader.wait(nb_graphs, timeout=10.) == nb_graphs
+    return [[tuple(edge) for edge in reader[i].tolist()]
+            for i in range(nb_graphs)]
+
+
+class TestSharedEnsemble:
+    """Tests for the shared-memory ensembles"""
+
+    def test_round_trip(self):
+        m_list = [2]*10
+        n_list = [4]*5
+        name = "/horgg_test_{}".format(os.getpid())
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        writer = SharedEnsembleWriter(name, m_list, n_list, capacity=3)
+        try:
+            reader = SharedEnsembleReader(name)
+            assert len(reader) == 0
+            graphs = []
+            for _ in range(3):
+                graphs.append(sampler.get_random_graph(10))
+                writer.write(sampler)
+            assert reader.wait(3, timeout=1.) == 3
+            for graph, edges in zip(graphs, (reader[i] for i in range(3))):
+                assert [tuple(edge) for edge in edges] == graph
+                assert not edges.flags.writeable
+            with pytest.raises(RuntimeError):
+                writer.write(sampler)
+            writer.close()
+            assert len(reader[2]) == 20
+        finally:
+            SharedEnsembleWriter.unlink(name)
+
+    def test_other_process(self):
+        m_list = [2]*10
+        n_list = [4]*5
+        name = "/horgg_test_{}".format(os.getpid())
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        writer = SharedEnsembleWriter(name, m_list, n_list, capacity=3)
+        try:
+            with multiprocessing.Pool(1) as pool:
+                result = pool.apply_async(read_shared_ensemble, (name, 3))
+                graphs = []
+                for _ in range(3):
+                    graphs.append(sampler.get_random_graph(10))
+                    writer.write(sampler)
+                assert result.get(timeout=30) == graphs
+            writer.close()
+        finally:
+            SharedEnsembleWriter.unlink(name)
+
+    def test_missing_segment(self):
+        name = "/horgg_missing_{}".format(os.getpid())
+        with pytest.raises(RuntimeError, match="No such file or directory"):
+            SharedEnsembleReader(name)
+
+    def test_capacity_too_large(self):
+        name = "/horgg_large_{}".format(os.getpid())
+        with pytest.raises(ValueError, match="too large"):
+            SharedEnsembleWriter(name, [2]*10, [4]*5, capacity=2**62)
+        with pytest.raises(RuntimeError, match="No such file or directory"):
+            SharedEnsembleReader(name)
@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Guillaume St-Onge
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Tests of the coroutine interface of Generator.hpp (C++20 only).
+ *
+ * Usage: test_generator
+ *
+ * Returns a nonzero exit code at the first failed check.
+ */
+
+#include "Generator.hpp"
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+using namespace std;
+using namespace horgg;
+
+namespace
+{//start of anonymous namespace
+
+int nb_failures = 0;
+
+void check(bool condition, const char* message)
+{
+    if (not condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", message);
+        nb_failures++;
+    }
+}
+
+bool same_edges(const EdgeListView& view, const EdgeList& edge_list)
+{
+    if (view.size() != edge_list.size())
+    {
+        return false;
+    }
+    size_t i = 0;
+    for (pair<Node,Group> edge : view)
+    {
+        if (edge != edge_list[i++])
+        {
+            return false;
+        }
+    }
+    return view.copy() == edge_list;
+}
+
+void test_thinned_samples(const MembershipSequence& membership_sequence,
+        const GroupSizeSequence& group_size_sequence)
+{
+    BipartiteConfigurationModelSampler sampler(membership_sequence,
+            group_size_sequence, RNGType(42));
+    size_t nb_samples = 0;
+    for (EdgeListView graph : thinned_samples(sampler, 5, 100))
+    {
+        check(same_edges(graph, sampler.get_graph()),
+                "thinned_samples views the graph of the sampler");
+        nb_samples++;
+    }
+    check(nb_samples == 5, "thinned_samples yields nb_samples graphs");
+}
+
+void test_random_graphs(const MembershipSequence& membership_sequence,
+        const GroupSizeSequence& group_size_sequence)
+{
+    BipartiteConfigurationModelSampler sampler(membership_sequence,
+            group_size_sequence, RNGType(42));
+    BipartiteConfigurationModelSampler reference(membership_sequence,
+            group_size_sequence, RNGType(42));
+    size_t nb_graphs = 0;
+    for (EdgeListView graph : random_graphs(sampler, 5))
+    {
+        check(same_edges(graph, reference.get_random_graph()),
+                "random_graphs matches get_random_graph");
+        nb_graphs++;
+    }
+    check(nb_graphs == 5, "random_graphs yields nb_graphs graphs");
+}
+
+void test_ensemble_samples(const MembershipSequence& membership_sequence,
+        const GroupSizeSequence& group_size_sequence, bool compress)
+{
+    string path = "test_generator_" + to_string(getpid())
+        + (compress ? "_compressed" : "_raw") + ".horgg";
+    BipartiteConfigurationModelSampler sampler(membership_sequence,
+            group_size_sequence, RNGType(42));
+    vector<EdgeList> graphs;
+    {
+        EnsembleWriter writer(path, membership_sequence, group_size_sequence,
+                42, compress);
+        for (size_t i = 0; i < 5; i++)
+        {
+            graphs.push_back(sampler.get_random_graph());
+            writer.write(graphs.back());
+        }
+        writer.close();
+    }
+    {
+        EnsembleReader reader(path);
+        size_t i = 0;
+        for (EdgeListView graph : ensemble_samples(reader))
+        {
+            check(i < graphs.size() and same_edges(graph, graphs[i]),
+                    "ensemble_samples matches the written graphs");
+            i++;
+        }
+        check(i == graphs.size(), "ensemble_samples yields every graph");
+    }
+    unlink(path.c_str());
+}
+
+}//end of anonymous namespace
+
+int main()
+{
+    MembershipSequence membership_sequence = {2, 2, 2, 2, 2, 3, 1, 2};
+    GroupSizeSequence group_size_sequence = {4, 4, 3, 3, 2};
+    test_thinned_samples(membership_sequence, group_size_sequence);
+    test_random_graphs(membership_sequence, group_size_sequence);
+    test_ensemble_samples(membership_sequence, group_size_sequence, false);
+    test_ensemble_samples(membership_sequence, group_size_sequence, true);
+    if (nb_failures == 0)
+    {
+        printf("all tests passed\n");
+    }
+    return nb_failures == 0 ? 0 : 1;
+}
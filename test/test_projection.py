@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Unit tests for the matrix representations of the graphs
+
+Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
+"""
+
+import numpy as np
+from horgg import BCMS, HyperedgeList
+
+
+def dense_projection(edge_list, nb_nodes):
+    """Reference node-to-node projection"""
+    groups = {}
+    for node, group in edge_list:
+        groups.setdefault(group, []).append(node)
+    adjacency = np.zeros((nb_nodes, nb_nodes), dtype=int)
+    for members in groups.values():
+        for u in members:
+            for v in members:
+                if u != v:
+                    adjacency[u, v] += 1
+    return adjacency
+
+
+class TestProjection:
+    """Tests for the node-to-node projection"""
+
+    def test_projection_weights(self):
+        m_list = [3]*20
+        n_list = [4]*15
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        sampler.get_random_graph(100)
+        data, indices, indptr = sampler.get_projection(nb_threads=2)
+        adjacency = np.zeros((20, 20), dtype=int)
+        for u in range(20):
+            for k in range(indptr[u], indptr[u+1]):
+                adjacency[u, indices[k]] = data[k]
+        assert np.array_equal(adjacency,
+                              dense_projection(sampler.get_graph(), 20))
+
+
+class TestIncidence:
+    """Tests for the incidence matrix export"""
+
+    def test_csr_and_csc(self):
+        m_list = [3]*20
+        n_list = [4]*15
+        sampler = BCMS(m_list, n_list)
+        edge_set = set(sampler.get_graph())
+        indices, indptr = sampler.get_incidence_csr()
+        assert np.array_equal(np.diff(indptr), m_list)
+        assert {(node, indices[k]) for node in range(20)
+                for k in range(indptr[node], indptr[node+1])} == edge_set
+        indices, indptr = sampler.get_incidence_csc()
+        assert np.array_equal(np.diff(indptr), n_list)
+        assert {(indices[k], group) for group in range(15)
+                for k in range(indptr[group], indptr[group+1])} == edge_set
+
+    def test_views_are_read_only(self):
+        sampler = BCMS([2]*6, [3]*4)
+        indices, indptr = sampler.get_incidence_csc(copy=False)
+        assert not indices.flags.writeable
+
+
+class TestHyperedges:
+    """Tests for the group membership lists"""
+
+    @staticmethod
+    def groups_of(edge_list, nb_groups):
+        groups = [[] for _ in range(nb_groups)]
+        for node, group in edge_list:
+            groups[group].append(node)
+        return [sorted(members) for members in groups]
+
+    def test_hyperedges(self):
+        sampler = BCMS([3]*20, [4]*15)
+        offsets, nodes = sampler.get_hyperedges()
+        groups = [sorted(nodes[offsets[g]:offsets[g+1]]) for g in range(15)]
+        assert groups == self.groups_of(sampler.get_graph(), 15)
+
+    def test_hyperedges_are_independent(self):
+        sampler = BCMS([3]*20, [4]*15)
+        offsets, nodes = sampler.get_hyperedges()
+        expected = nodes.copy()
+        sampler.get_random_graph(10)
+        sampler.get_incidence_csc(copy=False)
+        sampler.get_hyperedges()
+        assert np.array_equal(nodes, expected)
+
+    def test_incremental_hyperedges(self):
+        sampler = BCMS([3]*20, [4]*15)
+        hyperedges = HyperedgeList(sampler)
+        offsets, nodes = hyperedges.offsets, hyperedges.nodes
+        for _ in range(3):
+            for _ in range(50):
+                sampler.mcmc_step()
+            groups = [sorted(nodes[offsets[g]:offsets[g+1]])
+                      for g in range(15)]
+            assert groups == self.groups_of(sampler.get_graph(), 15)
+        sampler.get_random_graph(10)
+        groups = [sorted(nodes[offsets[g]:offsets[g+1]]) for g in range(15)]
+        assert groups == self.groups_of(sampler.get_graph(), 15)
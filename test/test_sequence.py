@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Unit tests for the sequence generators
+
+Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
+"""
+
+import pytest
+import numpy as np
+import horgg
+from horgg import BCMS
+from horgg.utility import sequence_1, sequence_2, sequence_2_exact
+
+class TestSequences:
+    """Tests for the sequences drawn from distributions"""
+
+    def test_sequence_1_support(self):
+        dist = [0, 0.5, 0, 0.5]
+        seq = sequence_1(1000, dist, seed=42)
+        assert len(seq) == 1000
+        assert set(np.unique(seq)) <= {1, 3}
+
+    def test_sequence_1_reproducible(self):
+        dist = [0.2, 0.3, 0.5]
+        np.random.seed(42)
+        seq1 = sequence_1(100, dist)
+        np.random.seed(42)
+        seq2 = sequence_1(100, dist)
+        assert np.array_equal(seq1, seq2)
+
+    def test_sequence_2_sum(self):
+        seq_1 = sequence_1(1000, [0, 0, 0.5, 0.5], seed=1)
+        seq_2 = sequence_2(seq_1, [0, 0.3, 0.3, 0.4], seed=2)
+        assert np.sum(seq_1) == np.sum(seq_2)
+        BCMS(seq_2, seq_1)
+
+    def test_sequence_2_exact_sum(self):
+        seq_1 = sequence_1(1000, [0, 0, 0.5, 0.5], seed=1)
+        seq_2 = sequence_2_exact(seq_1, [0.1, 0.3, 0.3, 0.3], seed=2,
+                                 ensure_bigraphic=True)
+        assert np.sum(seq_1) == np.sum(seq_2)
+        BCMS(seq_2, seq_1)
+
+    def test_sequence_2_exact_impossible_sum(self):
+        #only even values cannot sum to 3
+        with pytest.raises(ValueError):
+            sequence_2_exact([3], [0, 0, 1], seed=1)
+
+    def test_sequence_2_exact_only_zeros(self):
+        assert len(sequence_2_exact([0, 0], [1], seed=1)) == 0
+        with pytest.raises(ValueError):
+            sequence_2_exact([3], [1], seed=1)
+
+    def test_sequence_2_exact_sparse_support(self):
+        dist = np.zeros(10**6 + 2)
+        dist[1000] = dist[10**6 + 1] = 1
+        with pytest.raises(ValueError):
+            sequence_2_exact([3*10**6]*1000, dist, seed=1)
+
+    def test_invalid_distribution(self):
+        with pytest.raises(ValueError):
+            sequence_1(10, [-1, 2], seed=1)
+
+
+class TestPipeline:
+    """Tests for the one-call generation"""
+
+    def test_sample_graph_degrees(self):
+        pn = [0, 0, 0, 0, 1]
+        gm = [0, 0, 0, 1]
+        edges = horgg.sample_graph(pn, gm, 30, seed=42, nb_steps=30)
+        assert edges.shape == (120, 2)
+        assert np.all(np.bincount(edges[:, 1]) == 4)
+        assert np.all(np.bincount(edges[:, 0]) == 3)
+
+    def test_sample_graphs_independent_of_threads(self):
+        pn = [0, 0, 0, 0, 1]
+        gm = [0, 0, 0, 1]
+        graphs1 = horgg.sample_graphs(pn, gm, 30, 42, 8, nb_threads=1)
+        graphs4 = horgg.sample_graphs(pn, gm, 30, 42, 8, nb_threads=4)
+        for edges1, edges4 in zip(graphs1, graphs4):
+            assert np.array_equal(edges1, edges4)
+        assert np.array_equal(graphs1[2], horgg.sample_graphs(
+            pn, gm, 30, 42, 3, nb_threads=2)[2])
+
+    def test_unreachable_sum(self):
+        pn = [0, 0, 0, 1]
+        gm = [0, 0, 1]
+        with pytest.raises(RuntimeError):
+            horgg.sample_graph(pn, gm, 31, seed=42, max_attempts=5)
+        with pytest.raises(RuntimeError):
+            horgg.sample_graphs(pn, gm, 31, 42, 4, max_attempts=5)
+        with pytest.raises(ValueError):
+            horgg.sample_graph([-1, 2], gm, 31, seed=42)
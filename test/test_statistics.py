@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Unit tests for the statistics maintained along the Markov chain
+
+Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
+"""
+
+import numpy as np
+from horgg import BCMS, GroupOverlapTracker, ClusteringTracker, tune_chain, \
+    AssortativitySampler
+
+
+def incidence_matrix(edge_list, nb_nodes, nb_groups):
+    """Dense node-group incidence matrix"""
+    incidence = np.zeros((nb_nodes, nb_groups), dtype=int)
+    for node, group in edge_list:
+        incidence[node, group] = 1
+    return incidence
+
+
+def pair_distribution(shared):
+    """Distribution of the upper triangle of a pair count matrix"""
+    values = shared[np.triu_indices(len(shared), k=1)]
+    return list(np.bincount(values))
+
+
+class TestGroupOverlap:
+    """Tests for the incremental group overlap statistics"""
+
+    def check(self, tracker, sampler, nb_nodes, nb_groups):
+        incidence = incidence_matrix(sampler.get_graph(), nb_nodes,
+                                     nb_groups)
+        overlap = incidence.T @ incidence
+        co_membership = incidence @ incidence.T
+        assert tracker.overlap(0, 1) == overlap[0, 1]
+        assert tracker.co_membership(2, 3) == co_membership[2, 3]
+        expected = pair_distribution(overlap)
+        assert tracker.overlap_distribution[:len(expected)] == expected
+        expected = pair_distribution(co_membership)
+        assert tracker.co_membership_distribution[:len(expected)] \
+            == expected
+        assert tracker.nb_repeated_pairs == sum(expected[2:])
+
+    def test_incremental_statistics(self):
+        m_list = [3]*30
+        n_list = [5]*18
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        tracker = GroupOverlapTracker(sampler)
+        self.check(tracker, sampler, 30, 18)
+        for _ in range(5):
+            for _ in range(200):
+                sampler.mcmc_step()
+            self.check(tracker, sampler, 30, 18)
+        sampler.get_random_graph(10)
+        self.check(tracker, sampler, 30, 18)
+
+
+class TestClustering:
+    """Tests for the incremental clustering of the projection"""
+
+    def check(self, tracker, sampler, nb_nodes, nb_groups):
+        incidence = incidence_matrix(sampler.get_graph(), nb_nodes,
+                                     nb_groups)
+        adjacency = (incidence @ incidence.T > 0).astype(int)
+        np.fill_diagonal(adjacency, 0)
+        triangles = np.diag(adjacency @ adjacency @ adjacency) // 2
+        degree = adjacency.sum(axis=1)
+        triples = (degree*(degree-1)//2).sum()
+        assert tracker.nb_edges == adjacency.sum() // 2
+        assert tracker.nb_triangles == triangles.sum() // 3
+        assert np.isclose(tracker.global_clustering,
+                          triangles.sum()/triples)
+        local = np.divide(2*triangles, degree*(degree-1),
+                          out=np.zeros(nb_nodes),
+                          where=degree > 1)
+        assert np.isclose(tracker.local_clustering(0), local[0])
+        assert np.isclose(tracker.average_clustering, local.mean())
+
+    def test_incremental_clustering(self):
+        m_list = [2]*40
+        n_list = [4]*20
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        tracker = ClusteringTracker(sampler)
+        self.check(tracker, sampler, 40, 20)
+        for _ in range(5):
+            for _ in range(200):
+                sampler.mcmc_step()
+            self.check(tracker, sampler, 40, 20)
+        sampler.get_random_graph(10)
+        self.check(tracker, sampler, 40, 20)
+
+
+class TestTuneChain:
+    """Tests for the automatic burn-in and thinning"""
+
+    def test_schedule(self):
+        m_list = [3]*200
+        n_list = [5]*120
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        schedule = tune_chain(sampler, max_steps=10**6)
+        assert schedule.converged
+        assert schedule.burn_in_steps <= schedule.nb_steps // 2
+        assert schedule.nb_steps <= 10**6
+        assert schedule.thinning_steps >= 2*schedule.autocorrelation_time
+        sampler.mcmc_step(schedule.thinning_steps)
+        assert len(sampler.get_graph()) == sum(m_list)
+
+    def test_budget(self):
+        m_list = [3]*200
+        n_list = [5]*120
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        schedule = tune_chain(sampler, max_steps=500, interval=100)
+        assert not schedule.converged
+        assert schedule.nb_steps == schedule.burn_in_steps == 500
+
+
+class TestAssortativitySampler:
+    """Tests for the Metropolis-Hastings swaps biased by assortativity"""
+
+    def energy(self, graph):
+        membership = dict()
+        group_size = dict()
+        for node, group in graph:
+            membership[node] = membership.get(node, 0) + 1
+            group_size[group] = group_size.get(group, 0) + 1
+        return -sum(membership[node]*group_size[group]
+                    for node, group in graph)
+
+    def test_bias(self):
+        m_list = [1, 2, 3, 4, 5]*80
+        n_list = [2, 4, 6, 8, 10]*40
+        BCMS.seed(42)
+        sampler = BCMS(m_list, n_list)
+        sampler.get_random_graph(10000)
+        mh_sampler = AssortativitySampler(sampler, beta=0.05)
+        neutral = mh_sampler.assortativity
+        assert mh_sampler.mcmc_step(100000) > 0
+        assert mh_sampler.energy == self.energy(sampler.get_graph())
+        assert mh_sampler.assortativity > neutral + 0.05
+        mh_sampler.beta = -0.05
+        mh_sampler.mcmc_step(200000)
+        assert mh_sampler.energy == self.energy(sampler.get_graph())
+        assert mh_sampler.assortativity < neutral - 0.05
+
+    def test_reset(self):
+        sampler = BCMS([3]*50, [5]*30)
+        mh_sampler = AssortativitySampler(sampler, beta=1.)
+        sampler.get_random_graph(100)
+        assert mh_sampler.energy == self.energy(sampler.get_graph())
+        assert mh_sampler.assortativity == 0.
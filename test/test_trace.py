@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Unit tests for the phase tracing
+
+Author: Guillaume St-Onge <guillaume.st-onge.4@ulaval.ca>
+"""
+
+import json
+import horgg
+from horgg import BCMS
+
+
+class TestTrace:
+    """Tests for the recording and the output of spans"""
+
+    def record(self):
+        horgg.clear_trace()
+        horgg.enable_tracing()
+        try:
+            sampler = BCMS([3]*100, [5]*60)
+            sampler.get_random_graph(100)
+        finally:
+            horgg.disable_tracing()
+
+    def test_chrome_trace(self, tmp_path):
+        self.record()
+        path = str(tmp_path / "trace.json")
+        horgg.dump_chrome_trace(path)
+        with open(path) as file:
+            events = json.load(file)["traceEvents"]
+        names = {event["name"] for event in events}
+        assert {"shuffle", "repair", "edge_set", "mcmc"} <= names
+        for event in events:
+            assert event["ph"] == "X"
+            assert event["dur"] >= 0
+
+    def test_span_log(self, tmp_path):
+        self.record()
+        path = str(tmp_path / "spans.txt")
+        horgg.dump_span_log(path)
+        with open(path) as file:
+            spans = [line.split() for line in file]
+        assert "mcmc" in {span[3] for span in spans}
+        assert all(len(span) == 4 and int(span[2]) >= 0 for span in spans)
+
+    def test_disabled(self, tmp_path):
+        horgg.disable_tracing()
+        horgg.clear_trace()
+        BCMS([3]*100, [5]*60).get_random_graph(100)
+        path = str(tmp_path / "spans.txt")
+        horgg.dump_span_log(path)
+        with open(path) as file:
+            assert file.read() == ""